@@ -0,0 +1,119 @@
+/**
+ * @file stream_merger.h
+ * @brief Time-ordered k-way merge of per-zone fuel level streams
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef STREAM_MERGER_H
+#define STREAM_MERGER_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "../streaming/fuel_level_publisher.h"
+
+namespace Aggregator {
+
+/**
+ * @brief Counters describing merger behaviour
+ */
+struct MergerStats {
+    uint64_t emitted = 0;     ///< Samples forwarded upstream
+    uint64_t duplicates = 0;  ///< Samples already seen from the same zone
+    uint64_t late = 0;        ///< Samples older than what was already emitted (all zones)
+    uint64_t overflowed = 0;  ///< Samples dropped because a zone backlog was full
+};
+
+/**
+ * @class StreamMerger
+ * @brief Merges k zone streams into one stream ordered by sample timestamp
+ *
+ * Each zone has a FIFO of pending samples (zone streams are already in
+ * timestamp order). A sample is emitted once every connected zone has
+ * something pending, so the head with the smallest timestamp is known to be
+ * the global minimum. If a zone stays silent, heads older than the reorder
+ * window are emitted anyway so a quiet zone only delays the feed by that
+ * window.
+ *
+ * Ordering uses the wall-clock timestamps stamped by each zone, so zone
+ * clocks must agree to well within the reorder window. Samples from a zone
+ * whose clock lags further than that arrive older than what was already
+ * emitted and are dropped as late; these drops are counted per zone and
+ * logged.
+ */
+class StreamMerger {
+public:
+    using Clock = std::chrono::steady_clock;
+    using EmitFn = std::function<void(const Streaming::FuelSample&)>;
+
+    /**
+     * @brief Construct a new merger
+     *
+     * @param zone_count Number of input streams
+     * @param reorder_window Longest time a sample waits for slower zones
+     * @param emit Called in timestamp order for every merged sample
+     */
+    StreamMerger(std::size_t zone_count, std::chrono::milliseconds reorder_window, EmitFn emit);
+
+    /**
+     * @brief Add a sample received from a zone
+     *
+     * @param sample Sample with FuelSample::zone set to the source zone
+     */
+    void push(const Streaming::FuelSample& sample);
+
+    /**
+     * @brief Mark a zone as connected or disconnected
+     *
+     * Disconnected zones are not waited for.
+     *
+     * @param zone Zone index
+     * @param connected Whether the zone stream is up
+     */
+    void set_connected(std::size_t zone, bool connected);
+
+    /**
+     * @brief Emit heads that have waited longer than the reorder window
+     */
+    void flush_expired();
+
+    /**
+     * @brief Snapshot the merger counters
+     *
+     * @return MergerStats Current counters
+     */
+    MergerStats stats() const;
+
+private:
+    struct Pending {
+        Streaming::FuelSample sample;
+        Clock::time_point arrived;
+    };
+
+    struct Zone {
+        std::deque<Pending> pending;
+        uint64_t last_timestamp_ms = 0;
+        uint64_t late = 0;
+        bool connected = false;
+    };
+
+    // Emit while the smallest head is safe to release; caller holds mutex_
+    void drain(Clock::time_point now);
+
+    const std::chrono::milliseconds reorder_window_;
+    const EmitFn emit_;
+
+    mutable std::mutex mutex_;
+    std::vector<Zone> zones_;
+    uint64_t last_emitted_ms_ = 0;
+    MergerStats stats_;
+};
+
+} // namespace Aggregator
+
+#endif // STREAM_MERGER_H
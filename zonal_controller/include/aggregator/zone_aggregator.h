@@ -0,0 +1,116 @@
+/**
+ * @file zone_aggregator.h
+ * @brief Vehicle-level fan-in of several zone controllers
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef ZONE_AGGREGATOR_H
+#define ZONE_AGGREGATOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../config.hpp"
+#include "../streaming/fuel_level_publisher.h"
+#include "stream_merger.h"
+#include "zone_client.h"
+
+namespace Aggregator {
+
+/**
+ * @class ZoneAggregator
+ * @brief Connects to every configured zone and merges their streams
+ *
+ * Zone fuel streams are merged in timestamp order and published through a
+ * FuelLevelPublisher, so upstream subscribers get the same backpressure
+ * handling as on a single controller. A housekeeping thread releases
+ * samples held back by a silent zone once the reorder window expires.
+ */
+class ZoneAggregator {
+public:
+    /**
+     * @brief Construct a new aggregator
+     *
+     * Zone streams carry whole-second intervals, so the sample period is
+     * rounded up to a whole second (at least one) before it is requested
+     * from the zones and used as the merged publisher's period.
+     *
+     * @param zones Zone controllers to connect to
+     * @param sample_period Configured time between samples from one zone
+     * @param reorder_window Longest time a sample waits for slower zones
+     * @param rpc_timeout Deadline for calls routed to a zone
+     * @throw std::invalid_argument If no zones are configured
+     */
+    ZoneAggregator(const std::vector<zonal_controller::ZoneConfig>& zones,
+                   std::chrono::milliseconds sample_period,
+                   std::chrono::milliseconds reorder_window,
+                   std::chrono::milliseconds rpc_timeout);
+
+    /**
+     * @brief Disconnect from all zones
+     */
+    ~ZoneAggregator();
+
+    ZoneAggregator(const ZoneAggregator&) = delete;
+    ZoneAggregator& operator=(const ZoneAggregator&) = delete;
+
+    /**
+     * @brief Get the merged fuel level publisher
+     *
+     * @return Streaming::FuelLevelPublisher& Publisher fed by the merger
+     */
+    Streaming::FuelLevelPublisher& publisher() { return publisher_; }
+
+    /**
+     * @brief Get zone names indexed by FuelSample::zone
+     *
+     * @return const std::vector<std::string>& Zone names
+     */
+    const std::vector<std::string>& zone_names() const { return zone_names_; }
+
+    /**
+     * @brief Find the zone that owns a signal
+     *
+     * Falls back to the first zone when no zone claims the signal.
+     *
+     * @param signal Signal name such as "fuel" or "headlights"
+     * @return ZoneClient& Owning zone
+     */
+    ZoneClient& owner_of(const std::string& signal);
+
+    /**
+     * @brief Snapshot the merger counters
+     *
+     * @return MergerStats Current counters
+     */
+    MergerStats merger_stats() const { return merger_.stats(); }
+
+private:
+    /**
+     * @brief Periodically release samples whose reorder window expired
+     */
+    void FlushLoop();
+
+    const std::chrono::milliseconds reorder_window_;
+    const std::chrono::seconds stream_interval_;
+    std::vector<std::string> zone_names_;
+    Streaming::FuelLevelPublisher publisher_;
+    StreamMerger merger_;
+    std::vector<std::unique_ptr<ZoneClient>> zones_;
+
+    std::atomic<bool> running_{true};
+    std::mutex flush_mutex_;
+    std::condition_variable flush_cv_;
+    std::thread flush_thread_;
+};
+
+} // namespace Aggregator
+
+#endif // ZONE_AGGREGATOR_H
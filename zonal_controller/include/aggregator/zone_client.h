@@ -0,0 +1,161 @@
+/**
+ * @file zone_client.h
+ * @brief Persistent connection from the aggregator to one zone controller
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef ZONE_CLIENT_H
+#define ZONE_CLIENT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <grpcpp/grpcpp.h>
+#include "../config.hpp"
+#include "../streaming/fuel_level_publisher.h"
+#include "lighting_service.grpc.pb.h"
+#include "obd_service.grpc.pb.h"
+
+namespace Aggregator {
+
+/**
+ * @class ZoneClient
+ * @brief Keeps one channel open to a zone controller and follows its fuel stream
+ *
+ * The channel is created once and reused for every call. A background
+ * thread holds a StreamFuelLevel subscription open, reconnecting with
+ * exponential backoff, and reports each sample and connection change
+ * through callbacks. Unary lighting calls are forwarded on the same channel
+ * with the asynchronous callback stub, so no server thread waits on a zone.
+ */
+class ZoneClient {
+public:
+    using SampleFn = std::function<void(const Streaming::FuelSample&)>;
+    using StateFn = std::function<void(uint32_t zone, bool connected)>;
+    using DoneFn = std::function<void(grpc::Status)>;
+
+    /**
+     * @brief Construct a new zone client
+     *
+     * @param index Position of this zone in the aggregator, stamped on samples
+     * @param config Zone name, address and owned signals
+     * @param stream_interval Interval requested for the zone's fuel stream
+     * @param rpc_timeout Deadline for forwarded unary calls
+     */
+    ZoneClient(uint32_t index, const zonal_controller::ZoneConfig& config, std::chrono::seconds stream_interval,
+               std::chrono::milliseconds rpc_timeout);
+
+    /**
+     * @brief Stop the stream thread
+     */
+    ~ZoneClient();
+
+    ZoneClient(const ZoneClient&) = delete;
+    ZoneClient& operator=(const ZoneClient&) = delete;
+
+    /**
+     * @brief Start following the zone's fuel stream
+     *
+     * @param on_sample Called for every sample received
+     * @param on_state Called when the stream connects or drops
+     */
+    void start(SampleFn on_sample, StateFn on_state);
+
+    /**
+     * @brief Cancel the stream and join the background thread
+     */
+    void stop();
+
+    /**
+     * @brief Get the zone name
+     *
+     * @return const std::string& Name from config.yaml
+     */
+    const std::string& name() const { return config_.name; }
+
+    /**
+     * @brief Check whether this zone is authoritative for a signal
+     *
+     * @param signal Signal name such as "fuel" or "headlights"
+     * @return bool true if the zone lists the signal in owns
+     */
+    bool owns(const std::string& signal) const;
+
+    /**
+     * @brief Check whether the fuel stream is currently up
+     *
+     * @return bool true while connected
+     */
+    bool connected() const { return connected_; }
+
+    /**
+     * @brief Get the latest fuel sample received from this zone
+     *
+     * @param sample Receives the sample
+     * @return bool false if nothing has been received yet
+     */
+    bool latest(Streaming::FuelSample* sample) const;
+
+    /**
+     * @brief Forward a GetHeadlightState call to the zone without blocking
+     *
+     * @param response Filled with the zone's response; must stay valid until done runs
+     * @param done Called with the zone's status
+     */
+    void GetHeadlightState(lighting::GetHeadlightStateResponse* response, DoneFn done);
+
+    /**
+     * @brief Forward a SetHeadlight command to the zone without blocking
+     *
+     * @param request The command; must stay valid until done runs
+     * @param response Filled with the zone's response; must stay valid until done runs
+     * @param done Called with the zone's status
+     */
+    void SetHeadlight(const lighting::SetHeadlightRequest* request,
+                      lighting::SetHeadlightResponse* response, DoneFn done);
+
+private:
+    /**
+     * @brief Subscribe, read until the stream ends, back off and repeat
+     */
+    void StreamLoop();
+
+    /**
+     * @brief Create a client context with the forwarding deadline
+     *
+     * @return std::shared_ptr<grpc::ClientContext> Context kept alive by the completion callback
+     */
+    std::shared_ptr<grpc::ClientContext> MakeContext() const;
+
+    const uint32_t index_;
+    const zonal_controller::ZoneConfig config_;
+    const std::chrono::seconds stream_interval_;
+    const std::chrono::milliseconds rpc_timeout_;
+
+    std::shared_ptr<grpc::Channel> channel_;
+    std::unique_ptr<obd::OBDService::Stub> obd_stub_;
+    std::unique_ptr<lighting::LightingService::Stub> lighting_stub_;
+
+    SampleFn on_sample_;
+    StateFn on_state_;
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> connected_{false};
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    grpc::ClientContext* stream_context_ = nullptr;  ///< Active stream, guarded by mutex_
+    bool has_latest_ = false;
+    Streaming::FuelSample latest_;
+    std::thread thread_;
+};
+
+} // namespace Aggregator
+
+#endif // ZONE_CLIENT_H
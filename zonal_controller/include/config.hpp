@@ -2,10 +2,36 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 #include <yaml-cpp/yaml.h>
 
 namespace zonal_controller {
 
+// A downstream zone controller served by aggregator mode
+struct ZoneConfig {
+    std::string name;
+    std::string address;
+    std::vector<std::string> owns;  // Signals this zone is authoritative for ("fuel", "headlights")
+};
+
+// Threads and scheduling for one execution lane
+struct LaneConfig {
+    std::string name;
+    int threads = 1;
+    std::vector<int> cpus;      // CPUs the lane threads may run on (empty = any)
+    int schedFifoPriority = 0;  // SCHED_FIFO priority, 0 keeps the default policy
+    int nice = 0;               // Nice value used when SCHED_FIFO is off
+};
+
+// A rule evaluated by the rule engine
+struct RuleConfig {
+    std::string id;
+    std::string condition;
+    double hysteresis = 0.0;
+    int debounceMs = 0;
+    std::string message;
+};
+
 class Config {
 public:
     static Config& getInstance() {
@@ -24,6 +50,39 @@ public:
     int getServerPort() const { return serverPort; }
     const std::string& getLogFile() const { return logFile; }
     const std::string& getLogLevel() const { return logLevel; }
+    int getStreamSampleIntervalMs() const { return streamSampleIntervalMs; }
+    int getStreamQueueDepth() const { return streamQueueDepth; }
+    int getStreamMaxQueueDepth() const { return streamMaxQueueDepth; }
+    int getStreamMaxLagMs() const { return streamMaxLagMs; }
+    bool isAggregatorEnabled() const { return aggregatorEnabled; }
+    int getAggregatorReorderWindowMs() const { return aggregatorReorderWindowMs; }
+    int getAggregatorRpcTimeoutMs() const { return aggregatorRpcTimeoutMs; }
+    const std::vector<ZoneConfig>& getZones() const { return zones; }
+    const LaneConfig& getControlLane() const { return controlLane; }
+    const LaneConfig& getTelemetryLane() const { return telemetryLane; }
+    int getLaneReportIntervalS() const { return laneReportIntervalS; }
+    bool isHttpEnabled() const { return httpEnabled; }
+    const std::string& getHttpAddress() const { return httpAddress; }
+    int getHttpPort() const { return httpPort; }
+    int getHttpMaxConnections() const { return httpMaxConnections; }
+    const std::string& getVehicleId() const { return vehicleId; }
+    const std::vector<RuleConfig>& getRules() const { return rules; }
+    bool isTracingEnabled() const { return tracingEnabled; }
+    const std::string& getTracingOutputDir() const { return tracingOutputDir; }
+    int getTracingExportIntervalMs() const { return tracingExportIntervalMs; }
+    int getTracingBufferSpans() const { return tracingBufferSpans; }
+    int getTracingMaxFiles() const { return tracingMaxFiles; }
+    int getDiagnosticsSampleIntervalMs() const { return diagnosticsSampleIntervalMs; }
+    int getDiagnosticsHistory() const { return diagnosticsHistory; }
+    bool isObd2Enabled() const { return obd2Enabled; }
+    const std::string& getObd2Interface() const { return obd2Interface; }
+    int getObd2RequestId() const { return obd2RequestId; }
+    int getObd2FunctionalId() const { return obd2FunctionalId; }
+    int getObd2ResponseId() const { return obd2ResponseId; }
+    bool isObd2Padding() const { return obd2Padding; }
+    int getObd2PaddingByte() const { return obd2PaddingByte; }
+    const std::string& getObd2EcuName() const { return obd2EcuName; }
+    const std::string& getObd2Vin() const { return obd2Vin; }
 
 private:
     Config() = default;
@@ -33,6 +92,39 @@ private:
     int serverPort = 50051;
     std::string logFile = "zonal_controller.log";
     std::string logLevel = "INFO";
+    int streamSampleIntervalMs = 1000;
+    int streamQueueDepth = 16;
+    int streamMaxQueueDepth = 1024;
+    int streamMaxLagMs = 10000;
+    bool aggregatorEnabled = false;
+    int aggregatorReorderWindowMs = 20;
+    int aggregatorRpcTimeoutMs = 500;
+    std::vector<ZoneConfig> zones;
+    LaneConfig controlLane{"control", 1, {}, 0, 0};
+    LaneConfig telemetryLane{"telemetry", 1, {}, 0, 0};
+    int laneReportIntervalS = 10;
+    bool httpEnabled = false;
+    std::string httpAddress = "0.0.0.0";
+    int httpPort = 8080;
+    int httpMaxConnections = 64;
+    std::string vehicleId = "VIN123456789";
+    std::vector<RuleConfig> rules;
+    bool tracingEnabled = false;
+    std::string tracingOutputDir = "traces";
+    int tracingExportIntervalMs = 1000;
+    int tracingBufferSpans = 8192;
+    int tracingMaxFiles = 60;
+    int diagnosticsSampleIntervalMs = 1000;
+    int diagnosticsHistory = 300;
+    bool obd2Enabled = false;
+    std::string obd2Interface = "vcan0";
+    int obd2RequestId = 0x7E0;
+    int obd2FunctionalId = 0x7DF;
+    int obd2ResponseId = 0x7E8;
+    bool obd2Padding = true;
+    int obd2PaddingByte = 0xCC;
+    std::string obd2EcuName = "ZONALCTRL";
+    std::string obd2Vin = "1M8GDM9AXKP042788";
 };
 
 } // namespace zonal_controller 
\ No newline at end of file
@@ -0,0 +1,46 @@
+/**
+ * @file allocation_counters.h
+ * @brief Process-wide counters of C++ heap allocations
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef ALLOCATION_COUNTERS_H
+#define ALLOCATION_COUNTERS_H
+
+#include <cstdint>
+
+namespace Diagnostics {
+
+/**
+ * @brief Allocation totals since startup
+ */
+struct AllocationCounters {
+    uint64_t allocations = 0;      ///< Calls to operator new
+    uint64_t frees = 0;            ///< Calls to operator delete with a non-null pointer
+    uint64_t allocated_bytes = 0;  ///< Usable bytes handed out
+    uint64_t freed_bytes = 0;      ///< Usable bytes returned
+};
+
+/**
+ * @brief Read the allocation totals
+ *
+ * Counts everything allocated through the global operator new, which the
+ * controller replaces. Memory gRPC core allocates with malloc directly is
+ * not counted here; it shows up in the heap in-use figure instead.
+ *
+ * @return AllocationCounters Totals summed over all threads
+ */
+AllocationCounters ReadAllocationCounters();
+
+/**
+ * @brief Bytes currently allocated from malloc, by any code
+ *
+ * @return uint64_t In-use heap bytes
+ */
+uint64_t HeapInUseBytes();
+
+} // namespace Diagnostics
+
+#endif // ALLOCATION_COUNTERS_H
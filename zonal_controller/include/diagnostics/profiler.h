@@ -0,0 +1,85 @@
+/**
+ * @file profiler.h
+ * @brief On-demand sampling profiler for the running process
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Diagnostics {
+
+/**
+ * @brief Sample count for a function, folded stack or thread
+ */
+struct ProfileEntry {
+    std::string name;
+    uint64_t samples = 0;
+};
+
+/**
+ * @brief Aggregated result of a capture
+ */
+struct ProfileResult {
+    uint64_t samples = 0;
+    uint64_t lost = 0;                    ///< Samples dropped by the kernel
+    std::vector<ProfileEntry> functions;  ///< Leaf functions, most samples first
+    std::vector<ProfileEntry> stacks;     ///< Folded stacks "outer;...;leaf", most samples first
+    std::vector<ProfileEntry> threads;    ///< Samples per thread, most samples first
+};
+
+/**
+ * @brief Outcome of a capture request
+ */
+enum class CaptureStatus {
+    OK,      ///< The capture ran
+    BUSY,    ///< Another capture is running
+    FAILED   ///< Sampling could not be set up
+};
+
+/**
+ * @class Profiler
+ * @brief Samples user-space call stacks of every thread with perf_event_open
+ *
+ * Uses the CPU clock software event, which works without hardware PMU
+ * access (inside VMs too) and needs kernel.perf_event_paranoid <= 2 for a
+ * process to profile itself. Threads started during a capture are not
+ * sampled. Addresses are resolved with dladdr, so functions not exported
+ * from the executable appear as "module+0xoffset"; resolve those offline
+ * with addr2line. Only one capture runs at a time.
+ */
+class Profiler {
+public:
+    /**
+     * @brief Profile the process
+     *
+     * Blocks for the capture duration.
+     *
+     * @param duration Capture length
+     * @param frequency_hz Samples per second per thread
+     * @param max_entries Entries kept per list in the result
+     * @param cancelled Polled during the capture; returning true ends it early
+     * @param result Receives the aggregated samples
+     * @param error Receives the reason on failure
+     * @return CaptureStatus OK if the capture ran
+     */
+    CaptureStatus capture(std::chrono::seconds duration, int frequency_hz, std::size_t max_entries,
+                 const std::function<bool()>& cancelled, ProfileResult* result, std::string* error);
+
+private:
+    std::atomic<bool> busy_{false};
+};
+
+} // namespace Diagnostics
+
+#endif // PROFILER_H
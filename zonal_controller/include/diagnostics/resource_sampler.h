@@ -0,0 +1,140 @@
+/**
+ * @file resource_sampler.h
+ * @brief Periodic sampling of the controller's own resource usage
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef RESOURCE_SAMPLER_H
+#define RESOURCE_SAMPLER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "allocation_counters.h"
+#include "../http/sensor_http_server.h"
+#include "../rules/rule_engine.h"
+#include "../streaming/fuel_level_publisher.h"
+
+namespace Diagnostics {
+
+/**
+ * @brief CPU use of one thread
+ */
+struct ThreadUsage {
+    uint32_t tid = 0;          ///< Kernel thread id
+    std::string name;          ///< Thread name
+    double cpu_percent = 0.0;  ///< CPU use over the last interval (100 = one core)
+    uint64_t cpu_time_ms = 0;  ///< CPU time since the thread started
+};
+
+/**
+ * @brief Fill level of one bounded queue
+ */
+struct QueueDepth {
+    std::string name;       ///< Queue name
+    std::size_t depth = 0;  ///< Items buffered
+    std::size_t capacity = 0;
+    uint64_t dropped = 0;   ///< Items dropped or conflated so far
+};
+
+/**
+ * @brief Resource usage at one point in time
+ */
+struct ResourceSample {
+    uint64_t timestamp_ms = 0;
+    double cpu_percent = 0.0;         ///< Process CPU use over the last interval
+    uint64_t rss_bytes = 0;
+    uint64_t vm_bytes = 0;
+    uint64_t heap_in_use_bytes = 0;   ///< malloc bytes in use, from any code
+    AllocationCounters allocations;   ///< C++ allocation totals
+    std::size_t fuel_subscribers = 0;
+    std::size_t rule_watchers = 0;
+    std::size_t http_streams = 0;
+    int logger_backlog = 0;           ///< Log calls waiting for or holding the logger
+    std::vector<QueueDepth> queues;
+    std::vector<ThreadUsage> threads;
+};
+
+/**
+ * @brief Components the sampler reports on; any may be null
+ */
+struct SamplerSources {
+    Streaming::FuelLevelPublisher* publisher = nullptr;
+    Rules::RuleEngine* rules = nullptr;
+    Http::SensorHttpServer* http = nullptr;
+};
+
+/**
+ * @class ResourceSampler
+ * @brief Samples resource usage at a fixed rate into a ring of recent samples
+ *
+ * CPU figures come from /proc/self/stat and /proc/self/task/<tid>/stat and
+ * are computed from the change since the previous sample, so they are
+ * averages over the interval. Samples are built off the lock and swapped
+ * into their slot, so the ring reuses its storage once it has wrapped.
+ */
+class ResourceSampler {
+public:
+    /**
+     * @brief Start sampling
+     *
+     * @param interval Time between samples
+     * @param history Samples kept
+     * @param sources Components to report on (must outlive the sampler)
+     */
+    ResourceSampler(std::chrono::milliseconds interval, std::size_t history, SamplerSources sources);
+
+    /**
+     * @brief Stop sampling
+     */
+    ~ResourceSampler();
+
+    ResourceSampler(const ResourceSampler&) = delete;
+    ResourceSampler& operator=(const ResourceSampler&) = delete;
+
+    /**
+     * @brief Copy the most recent samples
+     *
+     * @param max_samples Samples to return (0 = all kept)
+     * @return std::vector<ResourceSample> Samples, oldest first
+     */
+    std::vector<ResourceSample> recent(std::size_t max_samples) const;
+
+    std::chrono::milliseconds interval() const { return interval_; }
+
+private:
+    void Run();
+    void Sample(ResourceSample& sample);
+    void SampleThreads(ResourceSample& sample, double elapsed_ticks);
+
+    const std::chrono::milliseconds interval_;
+    const SamplerSources sources_;
+    const long page_size_;
+
+    // Sampler thread only
+    ResourceSample scratch_;
+    std::chrono::steady_clock::time_point last_time_;
+    uint64_t last_process_ticks_ = 0;
+    std::unordered_map<uint32_t, uint64_t> last_thread_ticks_;
+    std::unordered_map<uint32_t, uint64_t> thread_ticks_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_ = true;
+    std::vector<ResourceSample> ring_;
+    std::size_t head_ = 0;   // Oldest sample
+    std::size_t count_ = 0;
+    std::thread thread_;
+};
+
+} // namespace Diagnostics
+
+#endif // RESOURCE_SAMPLER_H
@@ -0,0 +1,197 @@
+/**
+ * @file json_writer.h
+ * @brief Allocation-free JSON encoder over a fixed buffer
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace Http {
+
+/**
+ * @class JsonWriter
+ * @brief Writes one JSON document into storage reserved up front
+ *
+ * The writer only supports what the controller emits: nested objects with
+ * string, number and boolean members. Numbers are formatted with
+ * std::to_chars, so nothing is allocated and the locale is ignored. Output
+ * that does not fit is cut off and reported by ok(), never reallocated.
+ *
+ * @tparam Capacity Buffer size in bytes
+ */
+template <std::size_t Capacity>
+class JsonWriter {
+public:
+    /**
+     * @brief Discard the current document
+     */
+    void clear()
+    {
+        size_ = 0;
+        depth_ = 0;
+        overflow_ = false;
+        first_ = true;
+    }
+
+    /**
+     * @brief Open an object, as a member of the enclosing object if key is given
+     *
+     * @param key Member name, or empty for the top-level object
+     */
+    void begin_object(std::string_view key = {})
+    {
+        if (!key.empty()) write_key(key);
+        else separate();
+        put('{');
+        ++depth_;
+        first_ = true;
+    }
+
+    /**
+     * @brief Close the innermost object
+     */
+    void end_object()
+    {
+        put('}');
+        --depth_;
+        first_ = false;
+    }
+
+    void field(std::string_view key, std::string_view value)
+    {
+        write_key(key);
+        write_string(value);
+    }
+
+    void field(std::string_view key, const char* value) { field(key, std::string_view(value)); }
+
+    void field(std::string_view key, bool value)
+    {
+        write_key(key);
+        append(value ? std::string_view("true") : std::string_view("false"));
+    }
+
+    void field(std::string_view key, float value)
+    {
+        write_key(key);
+        write_number(value);
+    }
+
+    void field(std::string_view key, int64_t value)
+    {
+        write_key(key);
+        write_number(value);
+    }
+
+    void field(std::string_view key, uint64_t value)
+    {
+        write_key(key);
+        write_number(value);
+    }
+
+    void field(std::string_view key, int32_t value) { field(key, static_cast<int64_t>(value)); }
+    void field(std::string_view key, uint32_t value) { field(key, static_cast<uint64_t>(value)); }
+
+    /**
+     * @brief Check that the whole document fit
+     *
+     * @return bool false if output was truncated
+     */
+    bool ok() const { return !overflow_ && depth_ == 0; }
+
+    /**
+     * @brief Get the encoded document
+     *
+     * @return std::string_view View into the writer's buffer, valid until the next write
+     */
+    std::string_view view() const { return std::string_view(buffer_.data(), size_); }
+
+private:
+    void separate()
+    {
+        if (!first_) put(',');
+        first_ = false;
+    }
+
+    void write_key(std::string_view key)
+    {
+        separate();
+        write_string(key);
+        put(':');
+    }
+
+    void write_string(std::string_view value)
+    {
+        static const char kHex[] = "0123456789abcdef";
+        put('"');
+        for (char c : value) {
+            auto byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                put('\\');
+                put(c);
+            } else if (byte < 0x20) {
+                const char escaped[] = {'\\', 'u', '0', '0', kHex[byte >> 4], kHex[byte & 0x0f]};
+                append(std::string_view(escaped, sizeof(escaped)));
+            } else {
+                put(c);
+            }
+        }
+        put('"');
+    }
+
+    template <typename T>
+    void write_number(T value)
+    {
+        if constexpr (std::is_floating_point_v<T>) {
+            // JSON has no NaN or infinity
+            if (!std::isfinite(value)) {
+                append("null");
+                return;
+            }
+        }
+        auto result = std::to_chars(buffer_.data() + size_, buffer_.data() + Capacity, value);
+        if (result.ec != std::errc()) {
+            overflow_ = true;
+            return;
+        }
+        size_ = static_cast<std::size_t>(result.ptr - buffer_.data());
+    }
+
+    void put(char c)
+    {
+        if (size_ < Capacity) buffer_[size_++] = c;
+        else overflow_ = true;
+    }
+
+    void append(std::string_view text)
+    {
+        if (text.size() > Capacity - size_) {
+            overflow_ = true;
+            return;
+        }
+        std::memcpy(buffer_.data() + size_, text.data(), text.size());
+        size_ += text.size();
+    }
+
+    std::array<char, Capacity> buffer_;
+    std::size_t size_ = 0;
+    int depth_ = 0;
+    bool overflow_ = false;
+    bool first_ = true;
+};
+
+} // namespace Http
+
+#endif // JSON_WRITER_H
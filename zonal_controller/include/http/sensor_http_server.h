@@ -0,0 +1,158 @@
+/**
+ * @file sensor_http_server.h
+ * @brief HTTP/1.1 JSON and Server-Sent Events endpoint for sensor values
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef SENSOR_HTTP_SERVER_H
+#define SENSOR_HTTP_SERVER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "../streaming/fuel_level_publisher.h"
+#include "json_writer.h"
+
+namespace Http {
+
+/**
+ * @brief Settings for the HTTP endpoint
+ */
+struct HttpServerOptions {
+    std::string address = "0.0.0.0";  ///< Listen address
+    int port = 8080;                   ///< Listen port
+    std::size_t max_connections = 64;  ///< Connections served at once; more are refused
+    std::string vehicle_id;            ///< Reported as "vehicle_id" in every payload
+};
+
+/**
+ * @class SensorHttpServer
+ * @brief Serves the latest sensor values over HTTP without the gateway hops
+ *
+ * One thread runs an epoll loop over non-blocking sockets. It serves the
+ * same paths and payloads as the signal service gateway:
+ * - `GET /api/v1/vehicle/data/fuel_level`: JSON snapshot of the latest sample,
+ *   echoing the X-Request-ID header as "request_id" ("" when absent)
+ * - `GET /api/v1/vehicle/stream/fuel_level?interval=&max_updates=`: SSE stream;
+ *   as in the gateway, a missing, zero or invalid value means 2 s and 10 updates
+ *
+ * Differences from the gateway: the snapshot answers 503 until the first
+ * sample arrives, request IDs longer than 64 bytes are cut, "source_zone"
+ * is added in aggregator mode, and idle streams get a keepalive comment.
+ *
+ * Samples come straight from the FuelLevelPublisher. A feeder thread
+ * subscribes to it and hands each sample to the loop through a pipe. The
+ * loop encodes every sample once and copies the bytes to each stream that
+ * is due. Connection slots and their buffers are allocated at start, so
+ * serving requests does not allocate. A stream whose socket cannot keep up
+ * skips events instead of growing its buffer.
+ */
+class SensorHttpServer {
+public:
+    /**
+     * @brief Open the listening socket and start serving
+     *
+     * @param options Endpoint settings
+     * @param publisher Source of fuel samples (must outlive the server)
+     * @param zone_names Zone names reported as "source_zone" (empty outside aggregator mode)
+     * @throws std::runtime_error if the socket cannot be opened
+     */
+    SensorHttpServer(const HttpServerOptions& options, Streaming::FuelLevelPublisher& publisher,
+                     std::vector<std::string> zone_names = {});
+
+    /**
+     * @brief Stop serving and close every connection
+     */
+    ~SensorHttpServer();
+
+    SensorHttpServer(const SensorHttpServer&) = delete;
+    SensorHttpServer& operator=(const SensorHttpServer&) = delete;
+
+    /**
+     * @brief Number of Server-Sent Events streams currently open
+     *
+     * @return std::size_t Open streams
+     */
+    std::size_t stream_count() const { return open_streams_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr std::size_t kRequestBufferSize = 2048;
+    static constexpr std::size_t kResponseBufferSize = 16384;
+    static constexpr std::size_t kJsonBufferSize = 1024;
+
+    enum class ConnectionState { FREE, READING, WRITING, STREAMING };
+
+    struct Connection {
+        int fd = -1;
+        uint32_t generation = 0;  // Bumped when the slot is freed; stale epoll events carry an older one
+        ConnectionState state = ConnectionState::FREE;
+        bool keep_alive = false;
+        std::unique_ptr<char[]> in;
+        std::size_t in_size = 0;
+        std::unique_ptr<char[]> out;
+        std::size_t out_begin = 0;
+        std::size_t out_end = 0;
+
+        // Stream state
+        std::chrono::milliseconds interval{0};
+        uint64_t remaining = 0;  // Events left before the stream ends
+        std::vector<std::chrono::steady_clock::time_point> next_due;  // Per source zone
+        std::chrono::steady_clock::time_point last_write;
+        uint64_t skipped = 0;
+    };
+
+    void FeedLoop();
+    void EventLoop();
+
+    void Accept();
+    void OnReadable(Connection& connection);
+    void OnWritable(Connection& connection);
+    void ProcessRequests(Connection& connection);
+    void AfterWrite(Connection& connection);
+    void HandleRequest(Connection& connection, std::string_view request);
+    void StartStream(Connection& connection, std::string_view query);
+    void OnSample(const Streaming::FuelSample& sample);
+    void SendKeepalives(std::chrono::steady_clock::time_point now);
+
+    void EncodeSample(const Streaming::FuelSample& sample, bool as_event, std::string_view request_id = {});
+    void Respond(Connection& connection, int status, std::string_view reason, std::string_view body);
+    bool Enqueue(Connection& connection, std::string_view data);
+    bool Flush(Connection& connection);
+    uint64_t EventToken(const Connection& connection) const;
+    void UpdateInterest(Connection& connection);
+    void Close(Connection& connection);
+
+    const HttpServerOptions options_;
+    Streaming::FuelLevelPublisher& publisher_;
+    const std::vector<std::string> zone_names_;
+
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;         // eventfd used to stop the loop
+    int sample_pipe_[2] = {-1, -1};
+
+    std::vector<Connection> connections_;
+    std::vector<std::size_t> free_slots_;
+    JsonWriter<kJsonBufferSize> json_;
+    std::array<char, kJsonBufferSize + 16> event_;  // "data: <json>\n\n" for the current sample
+    std::size_t event_size_ = 0;
+
+    std::atomic<bool> running_{true};
+    std::atomic<std::size_t> open_streams_{0};
+    Streaming::FuelLevelPublisher::Subscription feeder_subscription_;
+    std::thread feeder_thread_;
+    std::thread loop_thread_;
+};
+
+} // namespace Http
+
+#endif // SENSOR_HTTP_SERVER_H
@@ -0,0 +1,199 @@
+/**
+ * @file execution_lane.h
+ * @brief Separate execution lanes for control and telemetry RPCs
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef EXECUTION_LANE_H
+#define EXECUTION_LANE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <grpcpp/grpcpp.h>
+#include "../config.hpp"
+#include "latency_histogram.h"
+
+namespace Lanes {
+
+/**
+ * @brief Execution lanes known to the controller
+ */
+enum class Lane {
+    CONTROL,    ///< Safety-relevant commands (lighting)
+    TELEMETRY   ///< Sensor reads and streams
+};
+
+/**
+ * @brief Get the lane name used in logs and config.yaml
+ *
+ * @param lane Lane
+ * @return const char* "control" or "telemetry"
+ */
+const char* LaneName(Lane lane);
+
+/// Metadata key carrying the client's send time, in microseconds since the Unix epoch
+constexpr const char* kSentAtMetadataKey = "x-sent-at-us";
+
+/**
+ * @brief Get the time a call started, for the lane latency histograms
+ *
+ * When the client sent its send time in kSentAtMetadataKey, the call is
+ * timed from there, so time spent queued before a handler ran (on the wire,
+ * in gRPC or in a completion queue) is included. Without it, or if the
+ * value is in the future or over a minute old (clock skew), the call is
+ * timed from now.
+ *
+ * @param context Server context of the call
+ * @return std::chrono::steady_clock::time_point Start time on the steady clock
+ */
+std::chrono::steady_clock::time_point CallStarted(const grpc::ServerContextBase& context);
+
+/**
+ * @brief Get the latency histogram of a lane
+ *
+ * @param lane Lane
+ * @return LatencyHistogram& Process-wide histogram for the lane
+ */
+LatencyHistogram& Histogram(Lane lane);
+
+/**
+ * @brief Apply CPU affinity and scheduling settings to the calling thread
+ *
+ * Failures (for example missing CAP_SYS_NICE for SCHED_FIFO) are logged
+ * and leave the thread with its previous settings.
+ *
+ * @param config Lane settings from config.yaml
+ */
+void ApplyThreadPolicy(const zonal_controller::LaneConfig& config);
+
+/**
+ * @brief Apply a lane's thread policy to the calling thread
+ *
+ * Called once at the top of a thread the controller owns and dedicates to
+ * the lane (the fuel sampler, the HTTP endpoint, zone streams). Never call
+ * it from an RPC handler: gRPC's pool threads are shared by every service,
+ * so the policy would follow the thread into unrelated calls.
+ *
+ * @param lane Lane to join
+ */
+void EnterLane(Lane lane);
+
+/**
+ * @class CompletionQueueLane
+ * @brief A dedicated completion queue served by its own pinned threads
+ *
+ * Async services register their calls on queue(). Each lane thread applies
+ * the lane's thread policy and then dispatches completion tags, so work on
+ * this lane never waits behind the gRPC thread pools used by other services.
+ */
+class CompletionQueueLane {
+public:
+    /**
+     * @brief Construct a new lane
+     *
+     * @param config Lane settings from config.yaml
+     * @param queue Completion queue obtained from ServerBuilder::AddCompletionQueue()
+     */
+    CompletionQueueLane(const zonal_controller::LaneConfig& config,
+                        std::unique_ptr<grpc::ServerCompletionQueue> queue);
+
+    /**
+     * @brief Stop the lane if still running
+     */
+    ~CompletionQueueLane();
+
+    CompletionQueueLane(const CompletionQueueLane&) = delete;
+    CompletionQueueLane& operator=(const CompletionQueueLane&) = delete;
+
+    /**
+     * @brief Get the lane's completion queue
+     *
+     * @return grpc::ServerCompletionQueue* Queue for async call registration
+     */
+    grpc::ServerCompletionQueue* queue() { return queue_.get(); }
+
+    /**
+     * @brief Start the lane threads
+     */
+    void start();
+
+    /**
+     * @brief Shut down the queue, drain it and join the threads
+     *
+     * Call after the server has been shut down.
+     */
+    void stop();
+
+    /**
+     * @brief Run a call registration unless the lane is stopping
+     *
+     * Registering on a queue that has been shut down is not allowed, so
+     * every re-arm of a call goes through here.
+     *
+     * @param request Function performing the Request<Method>() call
+     * @return bool false if the lane is stopping and nothing was registered
+     */
+    template <typename RequestFn>
+    bool arm(RequestFn&& request)
+    {
+        std::lock_guard<std::mutex> lock(arm_mutex_);
+        if (stopping_) return false;
+        request();
+        return true;
+    }
+
+private:
+    void Run();
+
+    const zonal_controller::LaneConfig config_;
+    std::unique_ptr<grpc::ServerCompletionQueue> queue_;
+    std::vector<std::thread> threads_;
+    std::mutex arm_mutex_;
+    bool stopping_ = false;
+};
+
+/**
+ * @class LatencyReporter
+ * @brief Logs per-lane latency percentiles at a fixed interval
+ *
+ * Each report covers only the calls since the previous one, so a
+ * saturated telemetry lane shows up as a rising telemetry p99 while the
+ * control p99 should stay flat.
+ */
+class LatencyReporter {
+public:
+    /**
+     * @brief Start reporting
+     *
+     * @param interval Time between reports (0 disables reporting)
+     */
+    explicit LatencyReporter(std::chrono::seconds interval);
+
+    /**
+     * @brief Stop reporting
+     */
+    ~LatencyReporter();
+
+    LatencyReporter(const LatencyReporter&) = delete;
+    LatencyReporter& operator=(const LatencyReporter&) = delete;
+
+private:
+    void Run();
+
+    const std::chrono::seconds interval_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_ = true;
+    std::thread thread_;
+};
+
+} // namespace Lanes
+
+#endif // EXECUTION_LANE_H
@@ -0,0 +1,105 @@
+/**
+ * @file latency_histogram.h
+ * @brief Lock-free log2 latency histogram
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace Lanes {
+
+/**
+ * @class LatencyHistogram
+ * @brief Counts latencies in power-of-two microsecond buckets
+ *
+ * record() is a single relaxed atomic increment, so it is safe to call
+ * from any handler thread without coordination. Percentiles are reported
+ * as the upper bound of the bucket that contains them.
+ */
+class LatencyHistogram {
+public:
+    static constexpr std::size_t kBuckets = 32;  ///< Bucket i holds [2^i, 2^(i+1)) microseconds
+    using Counts = std::array<uint64_t, kBuckets>;
+
+    /**
+     * @brief Record one latency sample
+     *
+     * @param latency Measured latency
+     */
+    void record(std::chrono::nanoseconds latency)
+    {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+        std::size_t bucket = 0;
+        while (us > 1 && bucket + 1 < kBuckets) {
+            us >>= 1;
+            ++bucket;
+        }
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Snapshot the bucket counts
+     *
+     * @return Counts Cumulative count per bucket
+     */
+    Counts counts() const
+    {
+        Counts result{};
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            result[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Total samples in a snapshot
+     *
+     * @param counts Bucket counts
+     * @return uint64_t Sum of all buckets
+     */
+    static uint64_t total(const Counts& counts)
+    {
+        uint64_t sum = 0;
+        for (uint64_t count : counts) sum += count;
+        return sum;
+    }
+
+    /**
+     * @brief Estimate a percentile from a snapshot
+     *
+     * @param counts Bucket counts (e.g. the difference of two snapshots)
+     * @param percentile Percentile in the range 0-100
+     * @return std::chrono::microseconds Upper bound of the bucket holding the percentile
+     */
+    static std::chrono::microseconds percentile(const Counts& counts, double percentile)
+    {
+        uint64_t sum = total(counts);
+        if (sum == 0) return std::chrono::microseconds(0);
+
+        auto rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(sum));
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            seen += counts[i];
+            if (seen > rank || seen == sum) {
+                return std::chrono::microseconds(uint64_t(1) << (i + 1));
+            }
+        }
+        return std::chrono::microseconds(uint64_t(1) << kBuckets);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+};
+
+} // namespace Lanes
+
+#endif // LATENCY_HISTOGRAM_H
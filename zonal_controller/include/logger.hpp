@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <atomic>
 #include <fstream>
 #include <mutex>
 #include <memory>
@@ -8,6 +9,7 @@
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include "tracing/span.h"
 
 namespace zonal_controller {
 
@@ -33,6 +35,11 @@ public:
         log_file_.open(filename, std::ios::app);
     }
 
+    // Log calls currently waiting for or holding the logger
+    int backlog() const {
+        return backlog_.load(std::memory_order_relaxed);
+    }
+
     template<typename... Args>
     void debug(const char* file, int line, const std::string& format, Args... args) {
         log(LogLevel::DEBUG, file, line, format, args...);
@@ -85,11 +92,15 @@ private:
         std::string fileStr(file);
         std::string fileSubStr = fileStr.substr(33);
 
+        // Covers the wait for the lock, so contention shows up in traces
+        TRACE_SPAN("Logger.log");
+        BacklogGuard backlog(backlog_);
         std::lock_guard<std::mutex> lock(mutex_);
         std::string message = formatMessage(format, args...);
         std::string log_entry = ss.str() + " [" + level_str + "] " + fileSubStr + ":" + 
                               std::to_string(line) + " - " + message + "\n";
 
+        TRACE_SPAN("Logger.flush");
         std::cout << log_entry;
         if (log_file_.is_open()) {
             log_file_ << log_entry;
@@ -97,6 +108,23 @@ private:
         }
     }
 
+    // Counts a log call in the backlog until it returns or throws
+    class BacklogGuard {
+    public:
+        explicit BacklogGuard(std::atomic<int>& backlog) : backlog_(backlog) {
+            backlog_.fetch_add(1, std::memory_order_relaxed);
+        }
+        ~BacklogGuard() {
+            backlog_.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        BacklogGuard(const BacklogGuard&) = delete;
+        BacklogGuard& operator=(const BacklogGuard&) = delete;
+
+    private:
+        std::atomic<int>& backlog_;
+    };
+
     // Base case for no arguments
     std::string formatMessage(const std::string& format) {
         return format;
@@ -143,6 +171,7 @@ private:
     std::mutex mutex_;
     std::ofstream log_file_;
     LogLevel log_level_;
+    std::atomic<int> backlog_{0};
 };
 
 } // namespace zonal_controller
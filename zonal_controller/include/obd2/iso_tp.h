@@ -0,0 +1,143 @@
+/**
+ * @file iso_tp.h
+ * @brief ISO 15765-2 (ISO-TP) framing over classic CAN
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef ISO_TP_H
+#define ISO_TP_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <linux/can.h>
+
+namespace Obd2 {
+
+constexpr std::size_t kSingleFrameMax = 7;         ///< Payload that fits in a single frame
+constexpr std::size_t kFirstFrameData = 6;         ///< Payload bytes carried by a first frame
+constexpr std::size_t kConsecutiveFrameData = 7;   ///< Payload bytes carried by a consecutive frame
+constexpr std::size_t kMaxMessageSize = 4095;      ///< Largest message a 12-bit length can describe
+
+/**
+ * @brief Protocol control information type (high nibble of the first byte)
+ */
+enum class FrameType : uint8_t {
+    SINGLE = 0,
+    FIRST = 1,
+    CONSECUTIVE = 2,
+    FLOW_CONTROL = 3,
+};
+
+/**
+ * @brief Flow status sent by the receiver of a segmented message
+ */
+enum class FlowStatus : uint8_t {
+    CONTINUE = 0,  ///< Clear to send the next block
+    WAIT = 1,      ///< Wait for another flow control frame
+    OVERFLOW = 2,  ///< Message too large; abort
+};
+
+/**
+ * @brief Frame layout settings
+ */
+struct IsoTpOptions {
+    bool padding = true;         ///< Pad every frame to 8 bytes (required by ISO 15765-4)
+    uint8_t padding_byte = 0xCC;
+};
+
+/**
+ * @brief Get the frame type of a received frame
+ *
+ * @param frame Received frame (must carry at least one byte)
+ * @return FrameType Type from the protocol control information
+ */
+inline FrameType TypeOf(const can_frame& frame)
+{
+    return static_cast<FrameType>(frame.data[0] >> 4);
+}
+
+/**
+ * @brief Build a single frame
+ *
+ * @param id CAN identifier
+ * @param data Payload (1 to kSingleFrameMax bytes)
+ * @param size Payload length
+ * @param options Frame layout
+ * @param frame Receives the frame
+ */
+void MakeSingleFrame(uint32_t id, const uint8_t* data, std::size_t size, const IsoTpOptions& options,
+                     can_frame& frame);
+
+/**
+ * @brief Build the first frame of a segmented message
+ *
+ * @param id CAN identifier
+ * @param data Message; the first kFirstFrameData bytes are sent
+ * @param size Full message length (8 to kMaxMessageSize)
+ * @param frame Receives the frame
+ */
+void MakeFirstFrame(uint32_t id, const uint8_t* data, std::size_t size, can_frame& frame);
+
+/**
+ * @brief Build a consecutive frame
+ *
+ * @param id CAN identifier
+ * @param sequence Sequence number (low four bits are used)
+ * @param data Payload (1 to kConsecutiveFrameData bytes)
+ * @param size Payload length
+ * @param options Frame layout
+ * @param frame Receives the frame
+ */
+void MakeConsecutiveFrame(uint32_t id, uint8_t sequence, const uint8_t* data, std::size_t size,
+                          const IsoTpOptions& options, can_frame& frame);
+
+/**
+ * @brief Build a flow control frame
+ *
+ * @param id CAN identifier
+ * @param status Flow status
+ * @param block_size Consecutive frames before the next flow control (0 = no limit)
+ * @param st_min Minimum separation time, encoded as on the wire
+ * @param options Frame layout
+ * @param frame Receives the frame
+ */
+void MakeFlowControl(uint32_t id, FlowStatus status, uint8_t block_size, uint8_t st_min,
+                     const IsoTpOptions& options, can_frame& frame);
+
+/**
+ * @brief Decode a separation time byte
+ *
+ * 0x00-0x7F are milliseconds, 0xF1-0xF9 are 100-900 microseconds.
+ * Reserved values are treated as 127 ms, as ISO 15765-2 requires.
+ *
+ * @param st_min Byte from a flow control frame
+ * @return std::chrono::microseconds Minimum gap between consecutive frames
+ */
+std::chrono::microseconds DecodeSeparationTime(uint8_t st_min);
+
+/**
+ * @brief Encode a separation time, rounding up to the next encodable value
+ *
+ * @param separation Minimum gap between consecutive frames
+ * @return uint8_t Byte for a flow control frame
+ */
+uint8_t EncodeSeparationTime(std::chrono::microseconds separation);
+
+/**
+ * @brief Open a non-blocking raw CAN socket that only receives the given identifiers
+ *
+ * @param interface CAN interface, e.g. "can0" or "vcan0"
+ * @param receive_ids 11-bit identifiers to receive
+ * @return int Socket file descriptor
+ * @throws std::runtime_error if the interface cannot be opened
+ */
+int OpenCanSocket(const std::string& interface, const std::vector<uint32_t>& receive_ids);
+
+} // namespace Obd2
+
+#endif // ISO_TP_H
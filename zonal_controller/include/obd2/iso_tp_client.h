@@ -0,0 +1,72 @@
+/**
+ * @file iso_tp_client.h
+ * @brief Tester side of ISO-TP: send a request, reassemble the response
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef ISO_TP_CLIENT_H
+#define ISO_TP_CLIENT_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "iso_tp.h"
+
+namespace Obd2 {
+
+/**
+ * @brief Identifiers and flow control used by the client
+ */
+struct IsoTpClientOptions {
+    uint32_t request_id = 0x7DF;       ///< Where requests are sent (0x7DF functional, 0x7E0 physical)
+    uint32_t response_id = 0x7E8;      ///< Where responses come from
+    uint32_t flow_control_id = 0x7E0;  ///< Where flow control frames are sent (always physical)
+    uint8_t block_size = 0;            ///< Consecutive frames between flow control frames (0 = no limit)
+    uint8_t st_min = 0;                ///< Separation time requested, encoded as on the wire
+    IsoTpOptions iso_tp;               ///< Frame padding
+};
+
+/**
+ * @class IsoTpClient
+ * @brief Sends single-frame requests and reads back one response each
+ *
+ * Used by the obd-probe harness. Requests must fit in a single frame,
+ * which every OBD-II request does.
+ */
+class IsoTpClient {
+public:
+    /**
+     * @brief Construct a client on an open socket
+     *
+     * @param socket Non-blocking socket carrying struct can_frame datagrams (not owned)
+     * @param options Identifiers and flow control
+     */
+    IsoTpClient(int socket, const IsoTpClientOptions& options) : socket_(socket), options_(options) {}
+
+    /**
+     * @brief Send a request and wait for the response
+     *
+     * @param request Request payload (1 to kSingleFrameMax bytes)
+     * @param size Request length
+     * @param response Receives the reassembled response
+     * @param timeout Time allowed for each frame of the response
+     * @param error Receives the reason on failure (may be nullptr)
+     * @return bool true if a complete response arrived
+     */
+    bool request(const uint8_t* request, std::size_t size, std::vector<uint8_t>& response,
+                 std::chrono::milliseconds timeout, std::string* error = nullptr);
+
+private:
+    bool Receive(can_frame& frame, std::chrono::steady_clock::time_point deadline, std::string* error);
+    bool Send(const can_frame& frame, std::string* error);
+
+    int socket_;
+    const IsoTpClientOptions options_;
+};
+
+} // namespace Obd2
+
+#endif // ISO_TP_CLIENT_H
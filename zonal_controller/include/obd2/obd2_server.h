@@ -0,0 +1,146 @@
+/**
+ * @file obd2_server.h
+ * @brief OBD-II Mode 01/09 server over ISO-TP on SocketCAN
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef OBD2_SERVER_H
+#define OBD2_SERVER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "iso_tp.h"
+#include "pid_table.h"
+#include "vehicle_state.h"
+
+namespace Obd2 {
+
+/**
+ * @brief Settings for the OBD-II server
+ */
+struct Obd2ServerOptions {
+    std::string interface = "vcan0";  ///< CAN interface
+    uint32_t request_id = 0x7E0;      ///< Physical request identifier
+    uint32_t functional_id = 0x7DF;   ///< Functional (broadcast) request identifier
+    uint32_t response_id = 0x7E8;     ///< Response identifier
+    IsoTpOptions iso_tp;              ///< Frame padding
+};
+
+/**
+ * @brief Counters kept by the server
+ */
+struct Obd2ServerStats {
+    uint64_t requests = 0;   ///< Requests received
+    uint64_t responses = 0;  ///< Responses sent completely (positive or negative)
+    uint64_t negative = 0;   ///< Negative responses
+    uint64_t segmented = 0;  ///< Responses that needed first and consecutive frames
+    uint64_t aborted = 0;    ///< Responses given up (write failure, timeout, overflow, new request)
+};
+
+/**
+ * @class Obd2Server
+ * @brief Answers OBD-II requests from scan tools on the CAN bus
+ *
+ * One thread reads a raw CAN socket and runs ISO-TP itself: requests
+ * arrive as single frames on the functional or physical identifier, and
+ * responses longer than seven bytes are sent as a first frame followed
+ * by consecutive frames, honouring the block size and separation time
+ * of the tester's flow control frames. The tester sends flow control on
+ * the physical identifier even when the request was functional, which a
+ * kernel ISO-TP socket (bound to one receive identifier) cannot follow.
+ *
+ * Values come from VehicleStateSource, so the bus sees the same fuel
+ * level as the gRPC and HTTP clients.
+ */
+class Obd2Server {
+public:
+    /**
+     * @brief Open the CAN interface and start serving
+     *
+     * @param options Server settings
+     * @param source Vehicle state (must outlive the server)
+     * @throws std::runtime_error if the interface cannot be opened
+     */
+    Obd2Server(const Obd2ServerOptions& options, const VehicleStateSource& source);
+
+    /**
+     * @brief Serve on a socket that is already open
+     *
+     * The socket must carry one struct can_frame per datagram and be
+     * non-blocking; the server closes it when it stops.
+     *
+     * @param options Server settings (the interface is not used)
+     * @param source Vehicle state (must outlive the server)
+     * @param socket Socket file descriptor
+     */
+    Obd2Server(const Obd2ServerOptions& options, const VehicleStateSource& source, int socket);
+
+    /**
+     * @brief Stop serving and close the socket
+     */
+    ~Obd2Server();
+
+    Obd2Server(const Obd2Server&) = delete;
+    Obd2Server& operator=(const Obd2Server&) = delete;
+
+    /**
+     * @brief Read the counters
+     *
+     * @return Obd2ServerStats Counters since the server started
+     */
+    Obd2ServerStats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // The response being sent
+    struct Transmission {
+        bool active = false;
+        bool started = false;  // Single or first frame written
+        bool waiting_flow_control = false;
+        std::array<uint8_t, kMaxResponseSize> data;
+        std::size_t size = 0;
+        std::size_t offset = 0;
+        uint8_t sequence = 0;
+        uint8_t block_size = 0;
+        uint8_t block_remaining = 0;
+        int waits = 0;
+        std::chrono::microseconds separation{0};
+        Clock::time_point next_frame;
+        Clock::time_point deadline;  // For the first frame write, then for each flow control frame
+    };
+
+    void Start();
+    void Loop();
+    void OnFrame(const can_frame& frame);
+    void HandleRequest(const uint8_t* request, std::size_t size, bool functional);
+    void SendFirstFrame(Clock::time_point now);
+    void OnFlowControl(const can_frame& frame);
+    void Transmit(Clock::time_point now);
+    void Abort(const char* reason);
+    bool Write(const can_frame& frame);
+
+    const Obd2ServerOptions options_;
+    const VehicleStateSource& source_;
+    int socket_ = -1;
+    int wake_fd_ = -1;  // eventfd used to stop the loop
+
+    Transmission tx_;
+
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> responses_{0};
+    std::atomic<uint64_t> negative_{0};
+    std::atomic<uint64_t> segmented_{0};
+    std::atomic<uint64_t> aborted_{0};
+    std::thread loop_thread_;
+};
+
+} // namespace Obd2
+
+#endif // OBD2_SERVER_H
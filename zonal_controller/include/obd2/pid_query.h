@@ -0,0 +1,38 @@
+/**
+ * @file pid_query.h
+ * @brief Shared QueryPids handling for every OBD service implementation
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef PID_QUERY_H
+#define PID_QUERY_H
+
+#include <grpcpp/grpcpp.h>
+#include "vehicle_state.h"
+#include "obd_service.pb.h"
+
+namespace Obd2 {
+
+constexpr int kMaxQueriesPerBatch = 64;  ///< PidQuery entries accepted in one QueryPids call
+
+/**
+ * @brief Answer a batch of OBD-II requests
+ *
+ * Each query is answered with BuildResponse exactly as if it had arrived
+ * on the CAN bus as a physical request, so a query with more than six
+ * PIDs gets the same negative response a scan tool would. Every query is
+ * encoded from the same state snapshot.
+ *
+ * @param state Values to encode
+ * @param request The batch
+ * @param response Response to fill (usually arena-allocated)
+ * @return grpc::Status OK, or INVALID_ARGUMENT for oversized batches and out-of-range bytes
+ */
+grpc::Status FillQueryPidsResponse(const VehicleState& state, const obd::QueryPidsRequest& request,
+                                   obd::QueryPidsResponse* response);
+
+} // namespace Obd2
+
+#endif // PID_QUERY_H
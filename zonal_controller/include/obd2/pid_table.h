@@ -0,0 +1,110 @@
+/**
+ * @file pid_table.h
+ * @brief Table-driven OBD-II Mode 01 and Mode 09 PID handlers
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef PID_TABLE_H
+#define PID_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "vehicle_state.h"
+
+namespace Obd2 {
+
+constexpr uint8_t kModeCurrentData = 0x01;  ///< Show current data
+constexpr uint8_t kModeVehicleInfo = 0x09;  ///< Request vehicle information
+
+constexpr uint8_t kPositiveResponseOffset = 0x40;  ///< Added to the mode in a positive response
+constexpr uint8_t kNegativeResponse = 0x7F;        ///< First byte of a negative response
+
+// Negative response codes (ISO 14229-1)
+constexpr uint8_t kServiceNotSupported = 0x11;
+constexpr uint8_t kSubFunctionNotSupported = 0x12;
+constexpr uint8_t kIncorrectMessageLength = 0x13;
+
+constexpr std::size_t kMaxPidsPerRequest = 6;  ///< SAE J1979 limit for one request
+constexpr std::size_t kMaxResponseSize = 64;   ///< Largest response BuildResponse produces
+
+/**
+ * @brief One PID the controller answers
+ *
+ * Handlers write exactly `length` bytes. Decoders turn those bytes back
+ * into the physical value a scan tool would show.
+ */
+struct PidHandler {
+    uint8_t pid;
+    uint8_t length;    ///< Data bytes after the PID byte
+    const char* name;
+    const char* unit;  ///< Empty for text or bit-field PIDs
+    void (*encode)(const VehicleState& state, uint8_t* out);
+    double (*decode)(const uint8_t* data);  ///< nullptr for text PIDs
+    bool text;         ///< Data is ASCII (after the Mode 09 item count byte)
+};
+
+/**
+ * @brief Find the handler for a PID
+ *
+ * The "PIDs supported" bitmaps (0x00, 0x20, ...) are not in the tables;
+ * they are computed from them and reported through Supported().
+ *
+ * @param mode kModeCurrentData or kModeVehicleInfo
+ * @param pid PID number
+ * @return const PidHandler* Handler, or nullptr if the PID is not served
+ */
+const PidHandler* FindPid(uint8_t mode, uint8_t pid);
+
+/**
+ * @brief Check whether a PID is answered, including the supported bitmaps
+ *
+ * @param mode OBD mode
+ * @param pid PID number
+ * @return bool true if a request for the PID gets data back
+ */
+bool Supported(uint8_t mode, uint8_t pid);
+
+/**
+ * @brief Encode one PID's data bytes (without the PID byte)
+ *
+ * @param mode OBD mode
+ * @param pid PID number
+ * @param state Values to encode
+ * @param out Receives the data (at least 32 bytes)
+ * @return std::size_t Bytes written, 0 if the PID is not supported
+ */
+std::size_t EncodePid(uint8_t mode, uint8_t pid, const VehicleState& state, uint8_t* out);
+
+/**
+ * @brief Result of BuildResponse
+ */
+enum class ResponseKind {
+    POSITIVE,  ///< Mode + 0x40 followed by PID and data for each supported PID
+    NEGATIVE,  ///< 0x7F, mode, response code
+    NONE,      ///< Nothing to send (no requested PID is supported)
+};
+
+/**
+ * @brief Build the response to an OBD-II request
+ *
+ * Up to kMaxPidsPerRequest PIDs can be requested at once. Unsupported
+ * PIDs are left out of the response; if none is supported, functional
+ * requests get no response and physical requests a negative one. Mode 09
+ * only allows several PIDs when they are all supported bitmaps.
+ *
+ * @param request Mode byte followed by the PIDs
+ * @param request_size Bytes in request
+ * @param state Values to encode
+ * @param functional true for requests to the broadcast address
+ * @param out Receives the response (kMaxResponseSize bytes)
+ * @param out_size Receives the response length
+ * @return ResponseKind What was written to out
+ */
+ResponseKind BuildResponse(const uint8_t* request, std::size_t request_size, const VehicleState& state,
+                           bool functional, uint8_t* out, std::size_t& out_size);
+
+} // namespace Obd2
+
+#endif // PID_TABLE_H
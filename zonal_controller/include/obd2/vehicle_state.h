@@ -0,0 +1,76 @@
+/**
+ * @file vehicle_state.h
+ * @brief Controller state answered through OBD-II PIDs
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef VEHICLE_STATE_H
+#define VEHICLE_STATE_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "../streaming/fuel_level_publisher.h"
+
+namespace Obd2 {
+
+/**
+ * @brief Values PID handlers encode
+ */
+struct VehicleState {
+    float fuel_level_percent = 0.0f;  ///< Latest fuel level sample
+    uint32_t run_time_s = 0;          ///< Seconds since the controller started
+    std::string_view vin;             ///< Vehicle identification number
+    std::string_view ecu_name;        ///< Name reported for Mode 09 PID 0A
+};
+
+/**
+ * @class VehicleStateSource
+ * @brief Builds VehicleState snapshots from the controller's sensor state
+ */
+class VehicleStateSource {
+public:
+    /**
+     * @brief Construct a new source
+     *
+     * @param publisher Fuel level publisher to read (must outlive the source)
+     * @param vin Vehicle identification number
+     * @param ecu_name ECU name
+     */
+    VehicleStateSource(Streaming::FuelLevelPublisher& publisher, std::string vin, std::string ecu_name)
+        : publisher_(publisher),
+          vin_(std::move(vin)),
+          ecu_name_(std::move(ecu_name)),
+          started_(std::chrono::steady_clock::now())
+    {
+    }
+
+    /**
+     * @brief Take a snapshot; string fields stay valid while the source lives
+     *
+     * @return VehicleState Current state
+     */
+    VehicleState snapshot() const
+    {
+        VehicleState state;
+        state.fuel_level_percent = publisher_.latest().level_percent;
+        state.run_time_s = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - started_).count());
+        state.vin = vin_;
+        state.ecu_name = ecu_name_;
+        return state;
+    }
+
+private:
+    Streaming::FuelLevelPublisher& publisher_;
+    const std::string vin_;
+    const std::string ecu_name_;
+    const std::chrono::steady_clock::time_point started_;
+};
+
+} // namespace Obd2
+
+#endif // VEHICLE_STATE_H
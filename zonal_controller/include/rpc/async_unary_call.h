@@ -0,0 +1,189 @@
+/**
+ * @file async_unary_call.h
+ * @brief Reusable async unary call state for completion-queue services
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef ASYNC_UNARY_CALL_H
+#define ASYNC_UNARY_CALL_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <google/protobuf/arena.h>
+#include <grpcpp/grpcpp.h>
+#include "../lanes/execution_lane.h"
+#include "../lanes/latency_histogram.h"
+#include "../tracing/trace_context.h"
+
+namespace Rpc {
+
+/**
+ * @class CompletionTag
+ * @brief Object whose address is used as a completion queue tag
+ */
+class CompletionTag {
+public:
+    virtual ~CompletionTag() = default;
+
+    /**
+     * @brief Advance the call after its pending operation completed
+     *
+     * @param ok Whether the operation succeeded
+     */
+    virtual void Proceed(bool ok) = 0;
+};
+
+/**
+ * @class AsyncUnaryCall
+ * @brief One in-flight slot for an async unary method
+ *
+ * A slot waits for a call, runs the handler and, once the response is sent,
+ * re-arms itself for the next call. Request and response live on the slot's
+ * arena, which is reset on every re-arm, so a running service does not
+ * allocate messages per call. The handler may finish the call
+ * synchronously or later from another thread.
+ *
+ * @tparam RequestT Request message type
+ * @tparam ResponseT Response message type
+ */
+template <typename RequestT, typename ResponseT>
+class AsyncUnaryCall final : public CompletionTag {
+public:
+    using Responder = grpc::ServerAsyncResponseWriter<ResponseT>;
+    using RequestFn = std::function<void(grpc::ServerContext*, RequestT*, Responder*,
+                                         grpc::ServerCompletionQueue*, void*)>;
+    using HandlerFn = std::function<void(AsyncUnaryCall&)>;
+
+    /**
+     * @brief Create slots for a method and register them on a lane
+     *
+     * Slots delete themselves when the lane shuts down.
+     *
+     * @param name Span name covering each call from delivery to Finish(); the
+     *             control lane histogram covers Lanes::CallStarted() to Finish()
+     * @param lane Lane whose completion queue delivers the calls
+     * @param slots Number of calls that can be in flight at once
+     * @param request Invokes the generated Request<Method>() of the service
+     * @param handler Handles a call and eventually calls Finish()
+     */
+    static void Spawn(const char* name, Lanes::CompletionQueueLane& lane, std::size_t slots, RequestFn request,
+                      HandlerFn handler)
+    {
+        auto shared_request = std::make_shared<RequestFn>(std::move(request));
+        auto shared_handler = std::make_shared<HandlerFn>(std::move(handler));
+        for (std::size_t i = 0; i < slots; ++i) {
+            (new AsyncUnaryCall(name, lane, shared_request, shared_handler))->Arm();
+        }
+    }
+
+    const RequestT& request() const { return *request_; }
+    ResponseT* response() { return response_; }
+    grpc::ServerContext& context() { return *context_; }
+
+    /**
+     * @brief Send the response and status to the client
+     *
+     * @param status Status to return
+     */
+    void Finish(const grpc::Status& status)
+    {
+        Lanes::Histogram(Lanes::Lane::CONTROL).record(std::chrono::steady_clock::now() - started_);
+        if (span_start_ != 0) {
+            Tracing::Record(name_, trace_id_, span_start_, Tracing::Now());
+        }
+        state_ = State::FINISHING;
+        responder_->Finish(*response_, status, this);
+    }
+
+    void Proceed(bool ok) override
+    {
+        switch (state_) {
+            case State::WAITING:
+                if (!ok) {
+                    // Server is shutting down and will deliver no more calls
+                    delete this;
+                    return;
+                }
+                started_ = Lanes::CallStarted(*context_);
+                state_ = State::HANDLING;
+                if (Tracing::Enabled()) {
+                    span_start_ = Tracing::Now();
+                    trace_id_ = Tracing::TraceIdFromMetadata(*context_);
+                }
+                {
+                    Tracing::ScopedTrace trace(trace_id_);
+                    (*handler_)(*this);
+                }
+                break;
+            case State::FINISHING:
+                Arm();
+                break;
+            case State::HANDLING:
+                break;
+        }
+    }
+
+private:
+    enum class State { WAITING, HANDLING, FINISHING };
+
+    // Arena block per slot; sized for the small lighting messages
+    static constexpr std::size_t kArenaBlockSize = 512;
+
+    AsyncUnaryCall(const char* name, Lanes::CompletionQueueLane& lane, std::shared_ptr<RequestFn> request,
+                   std::shared_ptr<HandlerFn> handler)
+        : name_(name),
+          lane_(lane),
+          request_fn_(std::move(request)),
+          handler_(std::move(handler)),
+          arena_(arena_block_, sizeof(arena_block_))
+    {
+    }
+
+    void Arm()
+    {
+        // ServerContext cannot be reused, so each call gets a fresh one in place
+        responder_.reset();
+        context_.reset();
+        arena_.Reset();
+
+        context_.emplace();
+        responder_.emplace(&*context_);
+        request_ = google::protobuf::Arena::CreateMessage<RequestT>(&arena_);
+        response_ = google::protobuf::Arena::CreateMessage<ResponseT>(&arena_);
+        state_ = State::WAITING;
+        span_start_ = 0;
+        trace_id_ = 0;
+
+        bool armed = lane_.arm([this] {
+            (*request_fn_)(&*context_, request_, &*responder_, lane_.queue(), this);
+        });
+        if (!armed) {
+            delete this;
+        }
+    }
+
+    const char* name_;
+    Lanes::CompletionQueueLane& lane_;
+    std::shared_ptr<RequestFn> request_fn_;
+    std::shared_ptr<HandlerFn> handler_;
+
+    alignas(8) char arena_block_[kArenaBlockSize];
+    google::protobuf::Arena arena_;
+    std::optional<grpc::ServerContext> context_;
+    std::optional<Responder> responder_;
+    RequestT* request_ = nullptr;
+    ResponseT* response_ = nullptr;
+    State state_ = State::WAITING;
+    std::chrono::steady_clock::time_point started_;
+    uint64_t span_start_ = 0;
+    uint64_t trace_id_ = 0;
+};
+
+} // namespace Rpc
+
+#endif // ASYNC_UNARY_CALL_H
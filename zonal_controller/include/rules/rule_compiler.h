@@ -0,0 +1,120 @@
+/**
+ * @file rule_compiler.h
+ * @brief Compilation of rule conditions into stack bytecode
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef RULE_COMPILER_H
+#define RULE_COMPILER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Rules {
+
+/**
+ * @brief Signals a rule condition can reference
+ */
+enum class Signal : uint8_t {
+    FUEL_LEVEL,  ///< Fuel level in percent ("fuel_level")
+    HEADLIGHTS,  ///< Headlights on = 1, off = 0 ("headlights")
+    COUNT
+};
+
+constexpr std::size_t kSignalCount = static_cast<std::size_t>(Signal::COUNT);
+
+/// Current value of every signal, indexed by Signal
+using SignalValues = std::array<double, kSignalCount>;
+
+/**
+ * @brief Get the name of a signal as written in conditions
+ *
+ * @param signal Signal
+ * @return const char* Signal name
+ */
+const char* SignalName(Signal signal);
+
+/**
+ * @brief Bytecode operations
+ */
+enum class OpCode : uint8_t {
+    PUSH_CONST,   ///< Push constants[arg]
+    LOAD_SIGNAL,  ///< Push signal arg
+    LT, LE, GT, GE, EQ, NE,
+    AND, OR, NOT
+};
+
+/**
+ * @brief One bytecode instruction
+ */
+struct Instruction {
+    OpCode op;
+    uint16_t arg;
+};
+
+/**
+ * @class Program
+ * @brief A compiled condition
+ *
+ * Conditions run on a small fixed stack, so evaluation never allocates.
+ * Ordered comparisons take a hysteresis margin: while a rule is raised,
+ * callers pass its hysteresis and each threshold is widened by it, so the
+ * value has to move back past the threshold by that margin to clear.
+ * Negations are pushed down to the comparisons at compile time, flipping
+ * each one, so the margin widens a negated threshold too.
+ */
+class Program {
+public:
+    static constexpr std::size_t kMaxStack = 16;
+
+    /**
+     * @brief Evaluate the condition
+     *
+     * @param signals Current signal values
+     * @param hysteresis Margin applied to ordered comparisons (0 for none)
+     * @return bool Whether the condition holds
+     */
+    bool evaluate(const SignalValues& signals, double hysteresis) const;
+
+    /**
+     * @brief Get the signals the condition reads
+     *
+     * @return uint32_t Bit (1 << Signal) set for each referenced signal
+     */
+    uint32_t signal_mask() const { return signal_mask_; }
+
+    std::size_t size() const { return code_.size(); }
+
+private:
+    friend class Compiler;
+
+    std::vector<Instruction> code_;
+    std::vector<double> constants_;
+    uint32_t signal_mask_ = 0;
+};
+
+/**
+ * @brief Compile a condition
+ *
+ * Grammar, lowest precedence first:
+ * - `a || b`, `a or b`
+ * - `a && b`, `a and b`
+ * - `!a`, `not a`
+ * - `a < b` (also `<=`, `>`, `>=`, `==`, `!=`)
+ * - numbers, `true`, `false`, signal names and parentheses
+ *
+ * @param condition Condition text
+ * @param program Receives the compiled program
+ * @param error Receives a description of the first error
+ * @return bool true on success
+ */
+bool Compile(const std::string& condition, Program* program, std::string* error);
+
+} // namespace Rules
+
+#endif // RULE_COMPILER_H
@@ -0,0 +1,207 @@
+/**
+ * @file rule_engine.h
+ * @brief Incremental evaluation of threshold and event rules
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef RULE_ENGINE_H
+#define RULE_ENGINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../streaming/fuel_level_publisher.h"
+#include "../streaming/subscriber_queue.h"
+#include "rule_compiler.h"
+
+namespace Rules {
+
+/**
+ * @brief A rule as configured or registered
+ */
+struct RuleDefinition {
+    std::string id;                        ///< Unique rule identifier
+    std::string condition;                 ///< Condition text (see Compile())
+    double hysteresis = 0.0;               ///< Margin needed to clear a raised threshold
+    std::chrono::milliseconds debounce{0}; ///< Time a change must persist before it is reported
+    std::string message;                   ///< Text included in every event
+};
+
+/**
+ * @brief A rule being raised or cleared
+ */
+struct RuleEvent {
+    std::string rule_id;       ///< Rule that changed state
+    bool raised = false;       ///< New state
+    uint64_t timestamp_ms = 0; ///< Transition time in milliseconds since epoch
+    std::string message;       ///< The rule's message
+    SignalValues signals{};    ///< Signal values at the transition
+    uint32_t known = 0;        ///< Bit (1 << Signal) set for each signal with a value
+};
+
+/**
+ * @brief Queue counters for one event watcher
+ */
+struct WatcherStats {
+    uint64_t id = 0;              ///< Watch identifier
+    Streaming::QueueStats queue;  ///< Queue counters
+};
+
+/**
+ * @class RuleEngine
+ * @brief Evaluates rules when the signals they read change
+ *
+ * update() only records the new value and wakes the evaluator thread. The
+ * evaluator takes every change recorded since its last pass and re-runs
+ * each rule that reads one of the changed signals, once per pass however
+ * many of its signals changed. Debounce deadlines are handled on the same
+ * thread. Rules that read a signal without a value yet are not evaluated.
+ * Raised and cleared events go to every watcher through a bounded queue.
+ */
+class RuleEngine {
+public:
+    using EventQueue = Streaming::SubscriberQueue<RuleEvent>;
+
+    /**
+     * @brief A registered event watcher
+     */
+    struct Watch {
+        uint64_t id = 0;                    ///< Identifier to pass to unwatch()
+        std::shared_ptr<EventQueue> queue;  ///< Queue the watcher drains
+    };
+
+    /**
+     * @brief Start the evaluator thread
+     */
+    RuleEngine();
+
+    /**
+     * @brief Stop the evaluator and feeder threads
+     */
+    ~RuleEngine();
+
+    RuleEngine(const RuleEngine&) = delete;
+    RuleEngine& operator=(const RuleEngine&) = delete;
+
+    /**
+     * @brief Compile and add a rule, replacing any rule with the same id
+     *
+     * A replaced rule that is raised is reported cleared first.
+     *
+     * @param definition Rule to add
+     * @param error Receives the compile error on failure
+     * @return bool true if the rule was added
+     */
+    bool add_rule(const RuleDefinition& definition, std::string* error);
+
+    /**
+     * @brief Remove a rule
+     *
+     * A raised rule is reported cleared before it is removed.
+     *
+     * @param id Rule identifier
+     * @return bool true if the rule existed
+     */
+    bool remove_rule(const std::string& id);
+
+    /**
+     * @brief Record a new signal value
+     *
+     * @param signal Signal that changed
+     * @param value New value
+     */
+    void update(Signal signal, double value);
+
+    /**
+     * @brief Feed the fuel level signal from a publisher
+     *
+     * @param publisher Publisher to subscribe to (must outlive the engine)
+     */
+    void feed_from(Streaming::FuelLevelPublisher& publisher);
+
+    /**
+     * @brief Snapshot the queue of every registered watcher
+     *
+     * @return std::vector<WatcherStats> One entry per watcher
+     */
+    std::vector<WatcherStats> watcher_stats() const;
+
+    /**
+     * @brief Register an event watcher
+     *
+     * @param rule_ids Rules to watch (empty = all)
+     * @param include_active Queue a raised event for each rule that is already raised
+     * @return Watch Handle for the new watcher
+     */
+    Watch watch(std::vector<std::string> rule_ids, bool include_active);
+
+    /**
+     * @brief Remove a watcher and close its queue
+     *
+     * @param id Watch identifier
+     */
+    void unwatch(uint64_t id);
+
+private:
+    struct Rule {
+        RuleDefinition definition;
+        Program program;
+        bool raised = false;
+        bool dirty = false;    // Queued for evaluation in the next pass
+        bool pending = false;  // A state change is waiting out its debounce
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    struct Watcher {
+        uint64_t id;
+        std::vector<std::string> rule_ids;
+        std::shared_ptr<EventQueue> queue;
+    };
+
+    static constexpr std::size_t kWatchQueueDepth = 64;
+
+    void EvalLoop();
+    void FeedLoop();
+    void Evaluate(Rule& rule, std::chrono::steady_clock::time_point now);
+    void Transition(Rule& rule);
+    RuleEvent MakeEvent(const Rule& rule) const;
+    void MarkDirty(Rule& rule);
+    void RebuildDependents();
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_ = true;
+
+    std::vector<std::unique_ptr<Rule>> rules_;
+    std::vector<Rule*> dependents_[kSignalCount];  // Rules reading each signal
+    std::vector<Rule*> dirty_;                     // Rules to evaluate in the next pass
+    std::vector<Rule*> pending_;                   // Rules waiting out a debounce
+
+    SignalValues values_{};
+    uint32_t known_ = 0;
+    uint32_t changed_ = 0;
+
+    std::vector<Watcher> watchers_;
+    uint64_t next_watch_id_ = 1;
+
+    uint64_t evaluations_ = 0;
+    uint64_t events_ = 0;
+
+    Streaming::FuelLevelPublisher* fuel_publisher_ = nullptr;
+    Streaming::FuelLevelPublisher::Subscription fuel_subscription_;
+    std::atomic<bool> feeding_{false};
+    std::thread feeder_thread_;
+    std::thread eval_thread_;
+};
+
+} // namespace Rules
+
+#endif // RULE_ENGINE_H
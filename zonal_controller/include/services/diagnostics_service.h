@@ -0,0 +1,77 @@
+/**
+ * @file diagnostics_service.h
+ * @brief gRPC service exposing resource samples and profile captures
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef DIAGNOSTICS_SERVICE_H
+#define DIAGNOSTICS_SERVICE_H
+
+#include <grpcpp/grpcpp.h>
+#include "../diagnostics/profiler.h"
+#include "../diagnostics/resource_sampler.h"
+#include "../rpc/arena_message_allocator.h"
+#include "diagnostics_service.grpc.pb.h"
+
+namespace Diagnostics
+{
+    /**
+     * @class DiagnosticsService
+     * @brief Reports the controller's own resource usage over gRPC
+     *
+     * Used by zc-top to watch a running controller without shelling into
+     * the box.
+     *
+     * GetSamples uses the callback API with a pooled arena allocator.
+     * CaptureProfile stays synchronous: it blocks for the whole capture,
+     * which must not happen on a callback thread.
+     */
+    class DiagnosticsService final
+        : public diagnostics::Diagnostics::WithCallbackMethod_GetSamples<diagnostics::Diagnostics::Service>
+    {
+    public:
+        /**
+         * @brief Construct a new DiagnosticsService object
+         *
+         * @param sampler Sampler providing the history (must outlive the service)
+         */
+        explicit DiagnosticsService(ResourceSampler &sampler);
+
+        /**
+         * @brief Return the most recent resource samples
+         *
+         * @param context Server context for the RPC
+         * @param request Number of samples wanted
+         * @param response Samples, oldest first
+         * @return grpc::ServerUnaryReactor* Reactor finished with OK
+         */
+        grpc::ServerUnaryReactor *GetSamples(grpc::CallbackServerContext *context,
+                                             const diagnostics::GetSamplesRequest *request,
+                                             diagnostics::GetSamplesResponse *response) override;
+
+        /**
+         * @brief Run a sampling profiler capture and return the aggregated result
+         *
+         * @param context Server context for the RPC
+         * @param request Capture length, frequency and result size
+         * @param response Functions, folded stacks and threads by sample count
+         * @return grpc::Status OK, INVALID_ARGUMENT for a bad duration, ABORTED if
+         *         a capture is already running, FAILED_PRECONDITION if perf is unavailable
+         */
+        grpc::Status CaptureProfile(grpc::ServerContext *context, const diagnostics::CaptureProfileRequest *request,
+                                    diagnostics::CaptureProfileResponse *response) override;
+
+    private:
+        ResourceSampler &sampler_; ///< Source of resource samples
+        Profiler profiler_;        ///< Serializes profile captures
+
+        /// Arena pool for GetSamples messages; the block fits the couple of samples zc-top polls
+        Rpc::ArenaMessageAllocator<diagnostics::GetSamplesRequest, diagnostics::GetSamplesResponse> samples_allocator_{
+            8192};
+    };
+
+} // namespace Diagnostics
+
+#endif // DIAGNOSTICS_SERVICE_H
@@ -9,8 +9,12 @@
 #ifndef LIGHTING_SERVICE_H
 #define LIGHTING_SERVICE_H
 
+#include <mutex>
 #include <grpcpp/grpcpp.h>
 #include "../hardware/body_lights.h"
+#include "../lanes/execution_lane.h"
+#include "../rpc/async_unary_call.h"
+#include "../rules/rule_engine.h"
 #include "lighting_service.grpc.pb.h"
 
 namespace Body
@@ -23,45 +27,53 @@ namespace Body
      * - Headlight state control
      * - Headlight state querying
      * - Error handling and status reporting
+     *
+     * Lighting is a control service, so both methods are served on the
+     * control lane's completion queue rather than the shared gRPC thread
+     * pool used by telemetry.
      */
-    class LightingService final : public lighting::LightingService::Service
+    class LightingService final : public lighting::LightingService::AsyncService
     {
     public:
+        using GetStateCall = Rpc::AsyncUnaryCall<lighting::GetHeadlightStateRequest, lighting::GetHeadlightStateResponse>;
+        using SetHeadlightCall = Rpc::AsyncUnaryCall<lighting::SetHeadlightRequest, lighting::SetHeadlightResponse>;
+
         /**
          * @brief Construct a new Lighting Service object
          *
          * Initializes the body lights controller with default values
+         *
+         * @param rules Rule engine that receives headlight changes (must outlive the service)
+         */
+        explicit LightingService(Rules::RuleEngine &rules);
+
+        /**
+         * @brief Start accepting calls on a lane
+         *
+         * Must be called after the server is built and before the lane is started.
+         *
+         * @param lane Control lane serving this service
          */
-        LightingService();
+        void Start(Lanes::CompletionQueueLane &lane);
 
+    private:
         /**
          * @brief Get the current headlight state
          *
-         * @param context Server context for the RPC
-         * @param request The headlight state request (unused in current implementation)
-         * @param response The response containing current headlight state
-         * @return grpc::Status OK on success, INTERNAL on error
+         * @param call Call carrying the request and response; finished with OK, or INTERNAL on error
          */
-        grpc::Status GetHeadlightState(
-            grpc::ServerContext *context,
-            const lighting::GetHeadlightStateRequest *request,
-            lighting::GetHeadlightStateResponse *response) override;
+        void GetHeadlightState(GetStateCall &call);
 
         /**
          * @brief Set the headlight state
          *
-         * @param context Server context for the RPC
-         * @param request The request containing desired headlight state
-         * @param response The response containing operation success status
-         * @return grpc::Status OK on success, INTERNAL on error
+         * @param call Call carrying the request and response; finished with OK, or INTERNAL on error
          */
-        grpc::Status SetHeadlight(
-            grpc::ServerContext *context,
-            const lighting::SetHeadlightRequest *request,
-            lighting::SetHeadlightResponse *response) override;
+        void SetHeadlight(SetHeadlightCall &call);
 
-    private:
         Body::Lights body_lights_; ///< Body lights controller instance
+        std::mutex lights_mutex_;  ///< Serializes lane threads on the controller
+        Rules::RuleEngine &rules_; ///< Receives the headlight signal
     };
 
 } // namespace Body
@@ -11,8 +11,15 @@
 
 #include <grpcpp/grpcpp.h>
 #include "../hardware/fuel_level_sensor.h"
+#include "../streaming/fuel_level_publisher.h"
+#include "../rpc/arena_message_allocator.h"
+#include "../obd2/vehicle_state.h"
 #include "obd_service.grpc.pb.h"
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 namespace OBD
 {
@@ -23,53 +30,111 @@ namespace OBD
      * This class provides the implementation of the OBD service, which handles:
      * - Real-time fuel level monitoring
      * - Fuel level streaming
+     * - Batched OBD-II PID reads
      * - Error handling and status reporting
+     *
+     * The fuel sensor is read by a single sampling thread. Samples reach
+     * stream subscribers through per-subscriber bounded queues, so a slow
+     * client never delays sampling or any other subscriber.
+     *
+     * GetFuelLevel and QueryPids use the callback API so their requests and
+     * responses live on a pooled protobuf arena instead of being
+     * heap-allocated per call.
      */
-    class OBDService final : public obd::OBDService::Service
+    class OBDService final
+        : public obd::OBDService::WithCallbackMethod_GetFuelLevel<
+              obd::OBDService::WithCallbackMethod_QueryPids<obd::OBDService::Service>>
     {
     public:
         /**
          * @brief Construct a new OBDService object
          *
-         * Initializes the fuel level sensor with default values and sets up
-         * necessary resources for the service.
+         * Initializes the fuel level sensor with default values and starts
+         * the sampling thread.
          */
         OBDService();
 
+        /**
+         * @brief Stop the sampling thread
+         */
+        ~OBDService();
+
         /**
          * @brief Get the current fuel level
          *
          * @param context Server context for the RPC
          * @param request The fuel level request (unused in current implementation)
          * @param response The response containing current fuel level and status
-         * @return grpc::Status OK on success, INTERNAL on error
+         * @return grpc::ServerUnaryReactor* Reactor finished with OK, or INTERNAL on error
          */
-        grpc::Status GetFuelLevel(grpc::ServerContext *context,
-                                  const obd::FuelLevelRequest *request,
-                                  obd::FuelLevelResponse *response) override;
+        grpc::ServerUnaryReactor *GetFuelLevel(grpc::CallbackServerContext *context,
+                                               const obd::FuelLevelRequest *request,
+                                               obd::FuelLevelResponse *response) override;
 
         /**
          * @brief Stream fuel level updates
          *
+         * Samples are delivered through a bounded queue governed by the
+         * request's backpressure policy. A DISCONNECT subscriber that lags
+         * too far receives RESOURCE_EXHAUSTED, or CANCELLED if it had
+         * stopped reading and the handler was blocked writing to it.
+         *
          * @param context Server context for the RPC
          * @param request The stream request containing update interval
          * @param writer Writer for streaming fuel level responses
-         * @return grpc::Status OK on success, INTERNAL on error
+         * @return grpc::Status OK on success, RESOURCE_EXHAUSTED if evicted while idle
          */
         grpc::Status StreamFuelLevel(grpc::ServerContext *context,
                                      const obd::FuelLevelStreamRequest *request,
                                      grpc::ServerWriter<obd::FuelLevelResponse> *writer) override;
 
-    private:
-        OBD::FuelLevelSensor fuel_sensor_; ///< Fuel level sensor instance
+        /**
+         * @brief Read a batch of OBD-II PIDs
+         *
+         * @param context Server context for the RPC
+         * @param request Modes and PIDs to read
+         * @param response One result per query, encoded as on the CAN bus
+         * @return grpc::ServerUnaryReactor* Reactor finished with OK, or INVALID_ARGUMENT for malformed batches
+         */
+        grpc::ServerUnaryReactor *QueryPids(grpc::CallbackServerContext *context,
+                                            const obd::QueryPidsRequest *request,
+                                            obd::QueryPidsResponse *response) override;
 
         /**
-         * @brief Create a fuel level response message
+         * @brief Get the publisher fed by the fuel level sampler
          *
-         * @param level Current fuel level percentage
-         * @return obd::FuelLevelResponse Response message with timestamp and status
+         * @return Streaming::FuelLevelPublisher& Publisher of this zone's samples
+         */
+        Streaming::FuelLevelPublisher &publisher() { return publisher_; }
+
+        /**
+         * @brief Get the state answered through OBD-II PIDs
+         *
+         * @return const Obd2::VehicleStateSource& State shared with the CAN server
+         */
+        const Obd2::VehicleStateSource &vehicle_state() const { return vehicle_state_; }
+
+    private:
+        OBD::FuelLevelSensor fuel_sensor_;       ///< Fuel level sensor instance
+        Streaming::FuelLevelPublisher publisher_; ///< Fan-out to stream subscribers
+        std::chrono::milliseconds sample_period_; ///< Time between sensor reads
+        Obd2::VehicleStateSource vehicle_state_;  ///< OBD-II view of the sensor state
+
+        std::atomic<bool> running_{true};        ///< Cleared to stop the sampler
+        std::mutex sampler_mutex_;               ///< Guards sampler_cv_ waits
+        std::condition_variable sampler_cv_;     ///< Wakes the sampler on shutdown
+        std::thread sampler_thread_;             ///< Sensor sampling thread
+
+        /// Arena pool for GetFuelLevel request and response messages
+        Rpc::ArenaMessageAllocator<obd::FuelLevelRequest, obd::FuelLevelResponse> fuel_level_allocator_;
+
+        /// Arena pool for QueryPids batches, sized for a few dozen PID results
+        Rpc::ArenaMessageAllocator<obd::QueryPidsRequest, obd::QueryPidsResponse> query_pids_allocator_{4096};
+
+        /**
+         * @brief Read the sensor every sample period and publish the result
          */
-        obd::FuelLevelResponse CreateFuelLevelResponse(float level);
+        void SampleLoop();
     };
 
 } // namespace OBD
@@ -0,0 +1,89 @@
+/**
+ * @file rule_service.h
+ * @brief gRPC service for registering rules and watching their events
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef RULE_SERVICE_H
+#define RULE_SERVICE_H
+
+#include <grpcpp/grpcpp.h>
+#include "../rpc/arena_message_allocator.h"
+#include "../rules/rule_engine.h"
+#include "rule_service.grpc.pb.h"
+
+namespace Rules
+{
+    /**
+     * @class RuleService
+     * @brief Exposes the rule engine over gRPC
+     *
+     * Clients that only need to know when a condition is met watch events
+     * instead of streaming every sample.
+     *
+     * RegisterRule and RemoveRule use the callback API so their messages
+     * live on pooled protobuf arenas, like the other unary RPCs.
+     */
+    class RuleService final
+        : public rules::RuleService::WithCallbackMethod_RegisterRule<
+              rules::RuleService::WithCallbackMethod_RemoveRule<rules::RuleService::Service>>
+    {
+    public:
+        /**
+         * @brief Construct a new RuleService object
+         *
+         * @param engine Rule engine to expose (must outlive the service)
+         */
+        explicit RuleService(RuleEngine &engine);
+
+        /**
+         * @brief Compile and register a rule
+         *
+         * @param context Server context for the RPC
+         * @param request The rule to register
+         * @param response Success flag and compile error
+         * @return grpc::ServerUnaryReactor* Reactor finished with OK, or
+         *         INVALID_ARGUMENT if the rule does not compile
+         */
+        grpc::ServerUnaryReactor *RegisterRule(grpc::CallbackServerContext *context,
+                                               const rules::RegisterRuleRequest *request,
+                                               rules::RegisterRuleResponse *response) override;
+
+        /**
+         * @brief Remove a rule
+         *
+         * @param context Server context for the RPC
+         * @param request The rule identifier
+         * @param response Whether the rule existed
+         * @return grpc::ServerUnaryReactor* Reactor finished with OK
+         */
+        grpc::ServerUnaryReactor *RemoveRule(grpc::CallbackServerContext *context,
+                                             const rules::RemoveRuleRequest *request,
+                                             rules::RemoveRuleResponse *response) override;
+
+        /**
+         * @brief Stream rule events until the client disconnects
+         *
+         * @param context Server context for the RPC
+         * @param request Rules to watch
+         * @param writer Writer for rule events
+         * @return grpc::Status OK
+         */
+        grpc::Status WatchEvents(grpc::ServerContext *context, const rules::WatchEventsRequest *request,
+                                 grpc::ServerWriter<rules::RuleEvent> *writer) override;
+
+    private:
+        RuleEngine &engine_; ///< Engine evaluating the rules
+
+        /// Arena pool for RegisterRule messages
+        Rpc::ArenaMessageAllocator<rules::RegisterRuleRequest, rules::RegisterRuleResponse> register_allocator_;
+
+        /// Arena pool for RemoveRule messages
+        Rpc::ArenaMessageAllocator<rules::RemoveRuleRequest, rules::RemoveRuleResponse> remove_allocator_{256};
+    };
+
+} // namespace Rules
+
+#endif // RULE_SERVICE_H
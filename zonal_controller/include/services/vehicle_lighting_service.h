@@ -0,0 +1,74 @@
+/**
+ * @file vehicle_lighting_service.h
+ * @brief Vehicle-level lighting gRPC service served in aggregator mode
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef VEHICLE_LIGHTING_SERVICE_H
+#define VEHICLE_LIGHTING_SERVICE_H
+
+#include <grpcpp/grpcpp.h>
+#include "../aggregator/zone_aggregator.h"
+#include "../lanes/execution_lane.h"
+#include "../rpc/async_unary_call.h"
+#include "../rules/rule_engine.h"
+#include "lighting_service.grpc.pb.h"
+
+namespace Aggregator
+{
+    /**
+     * @class VehicleLightingService
+     * @brief Lighting service that routes every call to the zone owning the headlights
+     *
+     * Calls arrive on the control lane and are forwarded asynchronously: the
+     * zone writes straight into the call's arena-allocated response and the
+     * call finishes from the client completion, so no lane thread blocks
+     * while a zone answers.
+     */
+    class VehicleLightingService final : public lighting::LightingService::AsyncService
+    {
+    public:
+        using GetStateCall = Rpc::AsyncUnaryCall<lighting::GetHeadlightStateRequest, lighting::GetHeadlightStateResponse>;
+        using SetHeadlightCall = Rpc::AsyncUnaryCall<lighting::SetHeadlightRequest, lighting::SetHeadlightResponse>;
+
+        /**
+         * @brief Construct a new VehicleLightingService object
+         *
+         * @param aggregator Aggregator providing zone connections (must outlive the service)
+         * @param rules Rule engine that receives headlight changes (must outlive the service)
+         */
+        VehicleLightingService(ZoneAggregator &aggregator, Rules::RuleEngine &rules);
+
+        /**
+         * @brief Start accepting calls on a lane
+         *
+         * Must be called after the server is built and before the lane is started.
+         *
+         * @param lane Control lane serving this service
+         */
+        void Start(Lanes::CompletionQueueLane &lane);
+
+    private:
+        /**
+         * @brief Get the headlight state from the owning zone
+         *
+         * @param call Call finished with the zone's status
+         */
+        void GetHeadlightState(GetStateCall &call);
+
+        /**
+         * @brief Forward a headlight command to the owning zone
+         *
+         * @param call Call finished with the zone's status
+         */
+        void SetHeadlight(SetHeadlightCall &call);
+
+        ZoneAggregator &aggregator_; ///< Source of zone connections
+        Rules::RuleEngine &rules_;   ///< Receives the headlight signal
+    };
+
+} // namespace Aggregator
+
+#endif // VEHICLE_LIGHTING_SERVICE_H
@@ -0,0 +1,97 @@
+/**
+ * @file vehicle_obd_service.h
+ * @brief Vehicle-level OBD gRPC service served in aggregator mode
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef VEHICLE_OBD_SERVICE_H
+#define VEHICLE_OBD_SERVICE_H
+
+#include <grpcpp/grpcpp.h>
+#include "../aggregator/zone_aggregator.h"
+#include "../rpc/arena_message_allocator.h"
+#include "../obd2/vehicle_state.h"
+#include "obd_service.grpc.pb.h"
+
+namespace Aggregator
+{
+    /**
+     * @class VehicleOBDService
+     * @brief OBD service answering for the whole vehicle from the zone aggregator
+     *
+     * Unary reads are served from the cached latest value of the zone that
+     * owns the fuel signal. Streams carry the time-ordered merge of every
+     * zone, with each sample tagged with its source zone. OBD-II PIDs are
+     * answered from the merged feed.
+     */
+    class VehicleOBDService final
+        : public obd::OBDService::WithCallbackMethod_GetFuelLevel<
+              obd::OBDService::WithCallbackMethod_QueryPids<obd::OBDService::Service>>
+    {
+    public:
+        /**
+         * @brief Construct a new VehicleOBDService object
+         *
+         * @param aggregator Aggregator providing zone data (must outlive the service)
+         */
+        explicit VehicleOBDService(ZoneAggregator &aggregator);
+
+        /**
+         * @brief Get the latest fuel level from the owning zone
+         *
+         * @param context Server context for the RPC
+         * @param request The fuel level request (unused in current implementation)
+         * @param response The response containing the cached fuel level
+         * @return grpc::ServerUnaryReactor* Reactor finished with OK, or UNAVAILABLE if the zone has not reported yet
+         */
+        grpc::ServerUnaryReactor *GetFuelLevel(grpc::CallbackServerContext *context,
+                                               const obd::FuelLevelRequest *request,
+                                               obd::FuelLevelResponse *response) override;
+
+        /**
+         * @brief Stream the merged fuel level feed of all zones
+         *
+         * @param context Server context for the RPC
+         * @param request The stream request containing update interval and backpressure settings
+         * @param writer Writer for streaming fuel level responses
+         * @return grpc::Status OK on success, RESOURCE_EXHAUSTED if evicted while idle
+         */
+        grpc::Status StreamFuelLevel(grpc::ServerContext *context,
+                                     const obd::FuelLevelStreamRequest *request,
+                                     grpc::ServerWriter<obd::FuelLevelResponse> *writer) override;
+
+        /**
+         * @brief Read a batch of OBD-II PIDs for the vehicle
+         *
+         * @param context Server context for the RPC
+         * @param request Modes and PIDs to read
+         * @param response One result per query, encoded as on the CAN bus
+         * @return grpc::ServerUnaryReactor* Reactor finished with OK, or INVALID_ARGUMENT for malformed batches
+         */
+        grpc::ServerUnaryReactor *QueryPids(grpc::CallbackServerContext *context,
+                                            const obd::QueryPidsRequest *request,
+                                            obd::QueryPidsResponse *response) override;
+
+        /**
+         * @brief Get the state answered through OBD-II PIDs
+         *
+         * @return const Obd2::VehicleStateSource& State shared with the CAN server
+         */
+        const Obd2::VehicleStateSource &vehicle_state() const { return vehicle_state_; }
+
+    private:
+        ZoneAggregator &aggregator_;             ///< Source of zone data
+        Obd2::VehicleStateSource vehicle_state_; ///< OBD-II view of the merged feed
+
+        /// Arena pool for GetFuelLevel request and response messages
+        Rpc::ArenaMessageAllocator<obd::FuelLevelRequest, obd::FuelLevelResponse> fuel_level_allocator_;
+
+        /// Arena pool for QueryPids batches, sized for a few dozen PID results
+        Rpc::ArenaMessageAllocator<obd::QueryPidsRequest, obd::QueryPidsResponse> query_pids_allocator_{4096};
+    };
+
+} // namespace Aggregator
+
+#endif // VEHICLE_OBD_SERVICE_H
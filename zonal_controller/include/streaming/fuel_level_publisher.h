@@ -0,0 +1,151 @@
+/**
+ * @file fuel_level_publisher.h
+ * @brief Fan-out of fuel level samples to stream subscribers
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef FUEL_LEVEL_PUBLISHER_H
+#define FUEL_LEVEL_PUBLISHER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "subscriber_queue.h"
+
+namespace Streaming {
+
+/**
+ * @brief One fuel level reading as produced by the sampler
+ */
+struct FuelSample {
+    float level_percent = 0.0f;  ///< Fuel level (0-100%)
+    uint64_t timestamp_ms = 0;   ///< Reading time in milliseconds since epoch
+    uint32_t zone = 0;           ///< Index of the producing zone (aggregator mode)
+};
+
+/**
+ * @brief Per-subscription delivery settings
+ */
+struct SubscriptionOptions {
+    OverflowPolicy policy = OverflowPolicy::CONFLATE;  ///< Overflow handling
+    std::size_t queue_depth = 1;                       ///< Queue capacity
+    std::chrono::milliseconds max_lag{0};              ///< DISCONNECT age threshold
+    std::chrono::milliseconds interval{1000};          ///< Minimum spacing between samples
+};
+
+/**
+ * @brief Counters for one live subscriber
+ */
+struct SubscriberStats {
+    uint64_t id = 0;                                   ///< Subscription identifier
+    OverflowPolicy policy = OverflowPolicy::CONFLATE;  ///< Overflow handling
+    QueueStats queue;                                  ///< Queue counters
+};
+
+/**
+ * @class FuelLevelPublisher
+ * @brief Distributes fuel samples to every subscriber through its own bounded queue
+ *
+ * publish() is called from the sampling thread and never waits on a
+ * subscriber: each subscriber owns a SubscriberQueue and a slow reader only
+ * affects its own queue. The most recent sample is cached for unary reads.
+ * The subscription interval is applied per source zone, so a merged
+ * multi-zone feed still carries every zone at the requested rate.
+ */
+class FuelLevelPublisher {
+public:
+    using Queue = SubscriberQueue<FuelSample>;
+
+    /**
+     * @brief A registered subscriber
+     */
+    struct Subscription {
+        uint64_t id = 0;               ///< Identifier to pass to unsubscribe()
+        std::shared_ptr<Queue> queue;  ///< Queue the subscriber drains
+    };
+
+    /**
+     * @brief Construct a new publisher
+     *
+     * @param sample_period Nominal time between samples from one zone
+     */
+    explicit FuelLevelPublisher(std::chrono::milliseconds sample_period);
+
+    /**
+     * @brief Register a subscriber
+     *
+     * @param options Delivery settings
+     * @param on_evict Called (outside the publisher lock) if the DISCONNECT policy evicts the subscriber
+     * @return Subscription Handle for the new subscriber
+     */
+    Subscription subscribe(const SubscriptionOptions& options, std::function<void()> on_evict = nullptr);
+
+    /**
+     * @brief Remove a subscriber and close its queue
+     *
+     * Waits for an eviction callback that is already running, so once this
+     * returns the subscriber's on_evict is never called again and anything
+     * it captured may be destroyed.
+     *
+     * @param id Subscription identifier
+     */
+    void unsubscribe(uint64_t id);
+
+    /**
+     * @brief Publish a sample to every subscriber that is due one
+     *
+     * @param sample Sample to publish
+     */
+    void publish(const FuelSample& sample);
+
+    /**
+     * @brief Get the most recently published sample
+     *
+     * @return FuelSample Latest sample (zeroed before the first publish)
+     */
+    FuelSample latest() const;
+
+    /**
+     * @brief Snapshot the counters of every live subscriber
+     *
+     * @return std::vector<SubscriberStats> One entry per subscriber
+     */
+    std::vector<SubscriberStats> stats() const;
+
+private:
+    /**
+     * @brief Eviction callback shared between publish() and unsubscribe()
+     *
+     * The callback runs under the hook's own mutex; unsubscribe() takes the
+     * same mutex to detach it, so it cannot return while the callback runs.
+     */
+    struct EvictHook {
+        std::mutex mutex;
+        std::function<void()> callback;  // Cleared once the subscriber is gone
+    };
+
+    struct Subscriber {
+        uint64_t id;
+        SubscriptionOptions options;
+        std::shared_ptr<Queue> queue;
+        std::shared_ptr<EvictHook> on_evict;
+        std::vector<std::chrono::steady_clock::time_point> next_due;  // Per source zone
+        bool evicted;
+    };
+
+    const std::chrono::milliseconds sample_period_;
+
+    mutable std::mutex mutex_;
+    std::vector<Subscriber> subscribers_;
+    uint64_t next_id_ = 1;
+    FuelSample latest_;
+};
+
+} // namespace Streaming
+
+#endif // FUEL_LEVEL_PUBLISHER_H
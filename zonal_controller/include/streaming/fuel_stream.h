@@ -0,0 +1,63 @@
+/**
+ * @file fuel_stream.h
+ * @brief Shared StreamFuelLevel handling for every OBD service implementation
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef FUEL_STREAM_H
+#define FUEL_STREAM_H
+
+#include <string>
+#include <vector>
+#include <grpcpp/grpcpp.h>
+#include "fuel_level_publisher.h"
+#include "obd_service.grpc.pb.h"
+
+namespace Streaming {
+
+/**
+ * @brief Translate a stream request into subscription settings
+ *
+ * Applies the server defaults from config.yaml and clamps the queue depth
+ * to the configured maximum.
+ *
+ * @param request The stream request
+ * @return SubscriptionOptions Options with server defaults applied
+ */
+SubscriptionOptions MakeSubscriptionOptions(const obd::FuelLevelStreamRequest& request);
+
+/**
+ * @brief Fill a fuel level response message from a sample
+ *
+ * @param sample Fuel level sample
+ * @param zone_names Zone names indexed by FuelSample::zone (empty for a single controller)
+ * @param response Response to fill
+ */
+void FillFuelLevelResponse(const FuelSample& sample, const std::vector<std::string>& zone_names,
+                           obd::FuelLevelResponse* response);
+
+/**
+ * @brief Serve one StreamFuelLevel call from a publisher
+ *
+ * Subscribes with the request's backpressure settings and writes samples
+ * until the client disconnects or is evicted. An evicted subscriber gets
+ * RESOURCE_EXHAUSTED, unless it was evicted while the handler was blocked
+ * writing to it; that call is cancelled and the client sees CANCELLED.
+ *
+ * @param publisher Source of samples
+ * @param context Server context for the RPC
+ * @param request The stream request
+ * @param writer Writer for streaming fuel level responses
+ * @param zone_names Zone names indexed by FuelSample::zone (empty for a single controller)
+ * @return grpc::Status OK on success, RESOURCE_EXHAUSTED if evicted while idle
+ */
+grpc::Status ServeFuelStream(FuelLevelPublisher& publisher, grpc::ServerContext* context,
+                             const obd::FuelLevelStreamRequest& request,
+                             grpc::ServerWriter<obd::FuelLevelResponse>* writer,
+                             const std::vector<std::string>& zone_names = {});
+
+} // namespace Streaming
+
+#endif // FUEL_STREAM_H
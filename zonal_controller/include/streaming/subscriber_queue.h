@@ -0,0 +1,217 @@
+/**
+ * @file subscriber_queue.h
+ * @brief Bounded per-subscriber sample queue with overflow policies
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef SUBSCRIBER_QUEUE_H
+#define SUBSCRIBER_QUEUE_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace Streaming {
+
+/**
+ * @brief What a queue does when a new sample arrives and it is full
+ */
+enum class OverflowPolicy {
+    CONFLATE,     ///< Keep only the newest sample (capacity is always 1)
+    DROP_OLDEST,  ///< Discard the oldest buffered sample
+    DISCONNECT    ///< Evict the subscriber
+};
+
+/**
+ * @brief Result of waiting on a subscriber queue
+ */
+enum class PopResult {
+    ITEM,     ///< A sample was returned
+    TIMEOUT,  ///< Nothing arrived within the timeout
+    CLOSED    ///< The queue was closed or the subscriber evicted
+};
+
+/**
+ * @brief Point-in-time counters for one subscriber queue
+ */
+struct QueueStats {
+    std::size_t depth = 0;          ///< Samples currently buffered
+    std::size_t capacity = 0;       ///< Maximum samples buffered
+    std::size_t max_depth = 0;      ///< Highest depth observed
+    uint64_t enqueued = 0;          ///< Samples offered to the queue
+    uint64_t delivered = 0;         ///< Samples handed to the writer
+    uint64_t dropped = 0;           ///< Samples discarded or conflated
+    int64_t lag_ms = 0;             ///< Age of the oldest buffered sample
+    bool evicted = false;           ///< Subscriber removed by the DISCONNECT policy
+};
+
+/**
+ * @class SubscriberQueue
+ * @brief Fixed-capacity ring buffer between a producer and one slow consumer
+ *
+ * The producer never blocks: push() always returns immediately and applies
+ * the overflow policy when the ring is full. Storage is allocated once at
+ * construction, so memory per subscriber stays bounded however far the
+ * consumer falls behind.
+ *
+ * @tparam T Sample type, copied into the ring
+ */
+template <typename T>
+class SubscriberQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Construct a new queue
+     *
+     * @param policy Overflow policy
+     * @param capacity Maximum samples buffered (forced to 1 for CONFLATE)
+     * @param max_lag Oldest sample age that evicts a DISCONNECT subscriber (0 = unlimited)
+     */
+    SubscriberQueue(OverflowPolicy policy, std::size_t capacity,
+                    std::chrono::milliseconds max_lag = std::chrono::milliseconds(0))
+        : policy_(policy),
+          max_lag_(max_lag),
+          ring_(policy == OverflowPolicy::CONFLATE ? 1 : std::max<std::size_t>(1, capacity))
+    {
+    }
+
+    SubscriberQueue(const SubscriberQueue&) = delete;
+    SubscriberQueue& operator=(const SubscriberQueue&) = delete;
+
+    /**
+     * @brief Offer a sample to the subscriber
+     *
+     * @param item Sample to enqueue
+     * @param now Time the sample was produced
+     * @return bool false if the queue is closed or the subscriber was just evicted
+     */
+    bool push(const T& item, Clock::time_point now = Clock::now())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) return false;
+
+            ++enqueued_;
+            if (count_ == ring_.size() || lagging(now)) {
+                switch (policy_) {
+                    case OverflowPolicy::CONFLATE:
+                    case OverflowPolicy::DROP_OLDEST:
+                        head_ = (head_ + 1) % ring_.size();
+                        --count_;
+                        ++dropped_;
+                        break;
+                    case OverflowPolicy::DISCONNECT:
+                        ++dropped_;
+                        evicted_ = true;
+                        closed_ = true;
+                        cv_.notify_all();
+                        return false;
+                }
+            }
+
+            Slot& slot = ring_[(head_ + count_) % ring_.size()];
+            slot.item = item;
+            slot.enqueued_at = now;
+            ++count_;
+            max_depth_ = std::max(max_depth_, count_);
+        }
+        cv_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Wait for the next sample
+     *
+     * @param out Receives the sample on PopResult::ITEM
+     * @param timeout Longest time to wait
+     * @return PopResult Outcome of the wait
+     */
+    PopResult pop(T& out, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cv_.wait_for(lock, timeout, [this] { return count_ > 0 || closed_; })) {
+            return PopResult::TIMEOUT;
+        }
+        if (count_ == 0) return PopResult::CLOSED;
+
+        out = ring_[head_].item;
+        head_ = (head_ + 1) % ring_.size();
+        --count_;
+        ++delivered_;
+        return PopResult::ITEM;
+    }
+
+    /**
+     * @brief Close the queue and wake any waiting consumer
+     */
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    /**
+     * @brief Snapshot the queue counters
+     *
+     * @return QueueStats Current counters
+     */
+    QueueStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        QueueStats stats;
+        stats.depth = count_;
+        stats.capacity = ring_.size();
+        stats.max_depth = max_depth_;
+        stats.enqueued = enqueued_;
+        stats.delivered = delivered_;
+        stats.dropped = dropped_;
+        stats.evicted = evicted_;
+        if (count_ > 0) {
+            stats.lag_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                Clock::now() - ring_[head_].enqueued_at).count();
+        }
+        return stats;
+    }
+
+private:
+    struct Slot {
+        T item{};
+        Clock::time_point enqueued_at;
+    };
+
+    // Only DISCONNECT subscribers are judged on age; the others simply overwrite
+    bool lagging(Clock::time_point now) const
+    {
+        return policy_ == OverflowPolicy::DISCONNECT && max_lag_.count() > 0 && count_ > 0 &&
+               now - ring_[head_].enqueued_at > max_lag_;
+    }
+
+    const OverflowPolicy policy_;
+    const std::chrono::milliseconds max_lag_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<Slot> ring_;
+    std::size_t head_ = 0;
+    std::size_t count_ = 0;
+    std::size_t max_depth_ = 0;
+    uint64_t enqueued_ = 0;
+    uint64_t delivered_ = 0;
+    uint64_t dropped_ = 0;
+    bool closed_ = false;
+    bool evicted_ = false;
+};
+
+} // namespace Streaming
+
+#endif // SUBSCRIBER_QUEUE_H
@@ -0,0 +1,168 @@
+/**
+ * @file span.h
+ * @brief Span recording into per-thread ring buffers
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef SPAN_H
+#define SPAN_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace Tracing {
+
+namespace detail {
+inline std::atomic<bool> g_enabled{false};
+inline thread_local uint64_t t_trace_id = 0;
+} // namespace detail
+
+/**
+ * @brief Check whether tracing is on
+ *
+ * A relaxed load, so disabled spans cost a load and a branch.
+ *
+ * @return bool true if spans are being recorded
+ */
+inline bool Enabled()
+{
+    return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Turn tracing on or off at runtime
+ *
+ * Only touches an atomic flag, so it is safe to call from a signal handler.
+ *
+ * @param enabled New state
+ */
+inline void SetEnabled(bool enabled)
+{
+    detail::g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Read the span clock
+ *
+ * The TSC on x86 (converted to wall time by the exporter), the steady
+ * clock in nanoseconds elsewhere.
+ *
+ * @return uint64_t Current tick count
+ */
+inline uint64_t Now()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/**
+ * @brief Get the trace the calling thread is working on
+ *
+ * @return uint64_t Trace identifier (0 = none)
+ */
+inline uint64_t CurrentTraceId()
+{
+    return detail::t_trace_id;
+}
+
+/**
+ * @brief Set the trace the calling thread is working on
+ *
+ * @param trace_id Trace identifier (0 = none)
+ */
+inline void SetCurrentTraceId(uint64_t trace_id)
+{
+    detail::t_trace_id = trace_id;
+}
+
+/**
+ * @brief Record a finished span in the calling thread's buffer
+ *
+ * Lock-free: the thread is the only writer of its buffer. A full buffer
+ * drops the span and counts it rather than waiting for the exporter.
+ *
+ * @param name Span name (must be a string literal or otherwise never freed)
+ * @param trace_id Trace the span belongs to
+ * @param start Start tick from Now()
+ * @param end End tick from Now()
+ */
+void Record(const char* name, uint64_t trace_id, uint64_t start, uint64_t end);
+
+/**
+ * @brief Set the span capacity of buffers created from now on
+ *
+ * @param spans Spans per thread (rounded up to a power of two)
+ */
+void SetBufferCapacity(std::size_t spans);
+
+/**
+ * @brief A recorded span as read back by the exporter
+ */
+struct SpanRecord {
+    const char* name;
+    uint64_t trace_id;
+    uint64_t start;
+    uint64_t end;
+    uint32_t tid;
+};
+
+/**
+ * @brief Move every buffered span out of the thread buffers
+ *
+ * @param out Receives the spans (appended)
+ * @return uint64_t Spans dropped on full buffers since the last call
+ */
+uint64_t Drain(std::vector<SpanRecord>& out);
+
+/**
+ * @brief Count the thread buffers allocated so far
+ *
+ * A thread's buffer is reused by the next new thread once it exits, so
+ * this tracks the peak number of recording threads, not every thread seen.
+ *
+ * @return std::size_t Buffers allocated
+ */
+std::size_t BufferCount();
+
+/**
+ * @class ScopedSpan
+ * @brief Records a span covering its own lifetime
+ */
+class ScopedSpan {
+public:
+    explicit ScopedSpan(const char* name) : name_(name), start_(Enabled() ? Now() : 0) {}
+
+    ~ScopedSpan()
+    {
+        if (start_ != 0) Record(name_, CurrentTraceId(), start_, Now());
+    }
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+private:
+    const char* name_;
+    uint64_t start_;
+};
+
+} // namespace Tracing
+
+#define TRACE_SPAN_CONCAT_INNER(a, b) a##b
+#define TRACE_SPAN_CONCAT(a, b) TRACE_SPAN_CONCAT_INNER(a, b)
+
+// Record a span from here to the end of the enclosing scope
+#define TRACE_SPAN(name) Tracing::ScopedSpan TRACE_SPAN_CONCAT(trace_span_, __LINE__)(name)
+
+#endif // SPAN_H
@@ -0,0 +1,68 @@
+/**
+ * @file trace_context.h
+ * @brief Trace identifiers carried in gRPC metadata
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef TRACE_CONTEXT_H
+#define TRACE_CONTEXT_H
+
+#include <cstdint>
+#include <grpcpp/grpcpp.h>
+#include "span.h"
+
+namespace Tracing {
+
+/**
+ * @brief Metadata key holding the caller's trace id as hex
+ */
+constexpr const char* kTraceIdKey = "x-trace-id";
+
+/**
+ * @brief Get the trace id of an incoming call
+ *
+ * Uses x-trace-id, or the low 64 bits of the trace id in a W3C
+ * traceparent header. Calls without either get a fresh id so their spans
+ * still group together.
+ *
+ * @param context Server context of the call
+ * @return uint64_t Trace identifier (never 0)
+ */
+uint64_t TraceIdFromMetadata(const grpc::ServerContextBase& context);
+
+/**
+ * @class ScopedTrace
+ * @brief Makes a call's trace current on the calling thread
+ *
+ * Spans recorded while it is alive belong to the call's trace. Metadata is
+ * only inspected while tracing is enabled.
+ */
+class ScopedTrace {
+public:
+    explicit ScopedTrace(const grpc::ServerContextBase& context) : previous_(CurrentTraceId())
+    {
+        if (Enabled()) SetCurrentTraceId(TraceIdFromMetadata(context));
+    }
+
+    explicit ScopedTrace(uint64_t trace_id) : previous_(CurrentTraceId())
+    {
+        SetCurrentTraceId(trace_id);
+    }
+
+    ~ScopedTrace()
+    {
+        SetCurrentTraceId(previous_);
+    }
+
+    ScopedTrace(const ScopedTrace&) = delete;
+    ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+private:
+    uint64_t previous_;
+};
+
+} // namespace Tracing
+
+#endif // TRACE_CONTEXT_H
@@ -0,0 +1,86 @@
+/**
+ * @file trace_exporter.h
+ * @brief Background export of recorded spans as Chrome trace JSON
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#ifndef TRACE_EXPORTER_H
+#define TRACE_EXPORTER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "span.h"
+
+namespace Tracing {
+
+/**
+ * @brief Trace export settings
+ */
+struct ExporterOptions {
+    std::string output_dir = "traces";         ///< Directory receiving trace files
+    std::chrono::milliseconds interval{1000};  ///< Time between exports
+    std::size_t max_files = 60;                ///< Files kept from this run (0 = all)
+};
+
+/**
+ * @class TraceExporter
+ * @brief Drains the span buffers and writes them to disk
+ *
+ * Every interval with spans produces one file in the Chrome trace event
+ * format, which both chrome://tracing and ui.perfetto.dev open. TSC ticks
+ * are converted to microseconds using a rate measured against the steady
+ * clock since the exporter started. Drained spans are written by this
+ * thread only, so recording threads never wait for I/O.
+ */
+class TraceExporter {
+public:
+    /**
+     * @brief Start the export thread
+     *
+     * @param options Export settings
+     */
+    explicit TraceExporter(ExporterOptions options);
+
+    /**
+     * @brief Export what is left and stop
+     */
+    ~TraceExporter();
+
+    TraceExporter(const TraceExporter&) = delete;
+    TraceExporter& operator=(const TraceExporter&) = delete;
+
+private:
+    void Run();
+    void Export();
+    bool WriteFile(const std::string& path) const;
+    double TicksPerMicrosecond() const;
+
+    const ExporterOptions options_;
+    const uint64_t origin_ticks_;
+    const std::chrono::steady_clock::time_point origin_time_;
+    const int pid_;
+    double calibrated_rate_ = 1.0;
+
+    std::vector<SpanRecord> spans_;
+    std::deque<std::string> files_;
+    uint64_t sequence_ = 0;
+    bool last_enabled_ = false;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_ = true;
+    std::thread thread_;
+};
+
+} // namespace Tracing
+
+#endif // TRACE_EXPORTER_H
@@ -0,0 +1,115 @@
+#include "../include/aggregator/stream_merger.h"
+#include <queue>
+#include <utility>
+#include "../include/logger.hpp"
+
+namespace Aggregator
+{
+    namespace
+    {
+        // Upper bound on samples held per zone while waiting for slower zones
+        constexpr std::size_t kMaxPendingPerZone = 256;
+
+        // A zone with a lagging clock drops every sample; warn on the first and then periodically
+        constexpr uint64_t kLateLogEvery = 100;
+    }
+
+    StreamMerger::StreamMerger(std::size_t zone_count, std::chrono::milliseconds reorder_window, EmitFn emit)
+        : reorder_window_(reorder_window), emit_(std::move(emit)), zones_(zone_count)
+    {
+    }
+
+    void StreamMerger::push(const Streaming::FuelSample &sample)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (sample.zone >= zones_.size()) return;
+
+        Zone &zone = zones_[sample.zone];
+        // Zone streams are ordered, so anything not newer than the last sample is a replay
+        if (sample.timestamp_ms <= zone.last_timestamp_ms) {
+            ++stats_.duplicates;
+            return;
+        }
+        zone.last_timestamp_ms = sample.timestamp_ms;
+
+        // Emitting this would break upstream ordering
+        if (sample.timestamp_ms < last_emitted_ms_) {
+            ++stats_.late;
+            if (zone.late++ % kLateLogEvery == 0) {
+                LOG_WARNING("Dropped late sample from zone {}: {} ms behind the merged feed ({} late so far); "
+                            "check that zone clocks are synchronised",
+                            sample.zone, last_emitted_ms_ - sample.timestamp_ms, zone.late);
+            }
+            return;
+        }
+
+        if (zone.pending.size() == kMaxPendingPerZone) {
+            zone.pending.pop_front();
+            ++stats_.overflowed;
+        }
+
+        auto now = Clock::now();
+        zone.pending.push_back({sample, now});
+        drain(now);
+    }
+
+    void StreamMerger::set_connected(std::size_t zone, bool connected)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (zone >= zones_.size()) return;
+
+        zones_[zone].connected = connected;
+        // Other zones may have been waiting on this one
+        drain(Clock::now());
+    }
+
+    void StreamMerger::flush_expired()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        drain(Clock::now());
+    }
+
+    MergerStats StreamMerger::stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    void StreamMerger::drain(Clock::time_point now)
+    {
+        // Min-heap of (timestamp, zone) over the head of every non-empty zone
+        using Head = std::pair<uint64_t, std::size_t>;
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+        std::size_t waiting = 0;
+
+        for (std::size_t i = 0; i < zones_.size(); ++i) {
+            if (!zones_[i].pending.empty()) {
+                heads.push({zones_[i].pending.front().sample.timestamp_ms, i});
+            } else if (zones_[i].connected) {
+                ++waiting;
+            }
+        }
+
+        while (!heads.empty()) {
+            std::size_t index = heads.top().second;
+            Zone &zone = zones_[index];
+            const Pending &head = zone.pending.front();
+
+            // A connected zone with nothing pending could still produce an older sample
+            if (waiting > 0 && now - head.arrived < reorder_window_) break;
+
+            heads.pop();
+            last_emitted_ms_ = head.sample.timestamp_ms;
+            ++stats_.emitted;
+            emit_(head.sample);
+            zone.pending.pop_front();
+
+            if (!zone.pending.empty()) {
+                heads.push({zone.pending.front().sample.timestamp_ms, index});
+            } else if (zone.connected) {
+                ++waiting;
+            }
+        }
+    }
+
+} // namespace Aggregator
@@ -0,0 +1,86 @@
+#include "../include/aggregator/zone_aggregator.h"
+#include <algorithm>
+#include <stdexcept>
+#include "../include/logger.hpp"
+
+namespace Aggregator
+{
+    ZoneAggregator::ZoneAggregator(const std::vector<zonal_controller::ZoneConfig> &zones,
+                                   std::chrono::milliseconds sample_period,
+                                   std::chrono::milliseconds reorder_window,
+                                   std::chrono::milliseconds rpc_timeout)
+        : reorder_window_(std::max(reorder_window, std::chrono::milliseconds(1))),
+          // Stream requests carry whole seconds, so zones deliver at most once a second
+          stream_interval_(std::max(std::chrono::ceil<std::chrono::seconds>(sample_period), std::chrono::seconds(1))),
+          publisher_(stream_interval_),
+          merger_(zones.size(), reorder_window_,
+                  [this](const Streaming::FuelSample &sample) { publisher_.publish(sample); })
+    {
+        if (zones.empty())
+        {
+            throw std::invalid_argument("Aggregator mode requires at least one zone in config.yaml");
+        }
+
+        for (uint32_t i = 0; i < zones.size(); ++i)
+        {
+            zone_names_.push_back(zones[i].name);
+            zones_.push_back(std::make_unique<ZoneClient>(i, zones[i], stream_interval_, rpc_timeout));
+        }
+
+        flush_thread_ = std::thread(&ZoneAggregator::FlushLoop, this);
+        for (auto &zone : zones_)
+        {
+            zone->start([this](const Streaming::FuelSample &sample) { merger_.push(sample); },
+                        [this](uint32_t index, bool connected) { merger_.set_connected(index, connected); });
+        }
+
+        LOG_INFO("Aggregating {} zones at {} s per sample with a {} ms reorder window", zones_.size(),
+                 static_cast<long>(stream_interval_.count()), static_cast<long>(reorder_window_.count()));
+    }
+
+    ZoneAggregator::~ZoneAggregator()
+    {
+        for (auto &zone : zones_)
+        {
+            zone->stop();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex_);
+            running_ = false;
+        }
+        flush_cv_.notify_all();
+        if (flush_thread_.joinable())
+        {
+            flush_thread_.join();
+        }
+
+        MergerStats stats = merger_.stats();
+        LOG_INFO("Aggregator stopped: emitted {}, duplicates {}, late {}, overflowed {}",
+                 stats.emitted, stats.duplicates, stats.late, stats.overflowed);
+    }
+
+    ZoneClient &ZoneAggregator::owner_of(const std::string &signal)
+    {
+        for (auto &zone : zones_)
+        {
+            if (zone->owns(signal))
+            {
+                return *zone;
+            }
+        }
+        return *zones_.front();
+    }
+
+    void ZoneAggregator::FlushLoop()
+    {
+        // Check twice per window so a held sample is released at most half a window late
+        auto period = std::max(reorder_window_ / 2, std::chrono::milliseconds(1));
+        std::unique_lock<std::mutex> lock(flush_mutex_);
+        while (!flush_cv_.wait_for(lock, period, [this] { return !running_; }))
+        {
+            merger_.flush_expired();
+        }
+    }
+
+} // namespace Aggregator
@@ -0,0 +1,163 @@
+#include "../include/aggregator/zone_client.h"
+#include <algorithm>
+#include "../include/lanes/execution_lane.h"
+#include "../include/logger.hpp"
+
+namespace Aggregator
+{
+    namespace
+    {
+        constexpr std::chrono::milliseconds kInitialBackoff(100);
+        constexpr std::chrono::milliseconds kMaxBackoff(5000);
+    }
+
+    ZoneClient::ZoneClient(uint32_t index, const zonal_controller::ZoneConfig &config,
+                           std::chrono::seconds stream_interval, std::chrono::milliseconds rpc_timeout)
+        : index_(index), config_(config), stream_interval_(stream_interval), rpc_timeout_(rpc_timeout)
+    {
+        // One long-lived channel per zone; keepalives notice a dead zone without traffic
+        grpc::ChannelArguments args;
+        args.SetInt(GRPC_ARG_KEEPALIVE_TIME_MS, 10000);
+        args.SetInt(GRPC_ARG_KEEPALIVE_TIMEOUT_MS, 2000);
+        args.SetInt(GRPC_ARG_KEEPALIVE_PERMIT_WITHOUT_CALLS, 1);
+        channel_ = grpc::CreateCustomChannel(config_.address, grpc::InsecureChannelCredentials(), args);
+        obd_stub_ = obd::OBDService::NewStub(channel_);
+        lighting_stub_ = lighting::LightingService::NewStub(channel_);
+
+        LOG_INFO("Zone {} configured at {}", config_.name, config_.address);
+    }
+
+    ZoneClient::~ZoneClient()
+    {
+        stop();
+    }
+
+    void ZoneClient::start(SampleFn on_sample, StateFn on_state)
+    {
+        on_sample_ = std::move(on_sample);
+        on_state_ = std::move(on_state);
+        running_ = true;
+        thread_ = std::thread(&ZoneClient::StreamLoop, this);
+    }
+
+    void ZoneClient::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+            if (stream_context_)
+            {
+                stream_context_->TryCancel();
+            }
+        }
+        cv_.notify_all();
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+    }
+
+    bool ZoneClient::owns(const std::string &signal) const
+    {
+        return std::find(config_.owns.begin(), config_.owns.end(), signal) != config_.owns.end();
+    }
+
+    bool ZoneClient::latest(Streaming::FuelSample *sample) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!has_latest_) return false;
+        *sample = latest_;
+        return true;
+    }
+
+    void ZoneClient::GetHeadlightState(lighting::GetHeadlightStateResponse *response, DoneFn done)
+    {
+        static const lighting::GetHeadlightStateRequest kRequest;
+        auto context = MakeContext();
+        lighting_stub_->async()->GetHeadlightState(
+            context.get(), &kRequest, response,
+            [context, done = std::move(done)](grpc::Status status) { done(std::move(status)); });
+    }
+
+    void ZoneClient::SetHeadlight(const lighting::SetHeadlightRequest *request,
+                                  lighting::SetHeadlightResponse *response, DoneFn done)
+    {
+        auto context = MakeContext();
+        lighting_stub_->async()->SetHeadlight(
+            context.get(), request, response,
+            [context, done = std::move(done)](grpc::Status status) { done(std::move(status)); });
+    }
+
+    std::shared_ptr<grpc::ClientContext> ZoneClient::MakeContext() const
+    {
+        auto context = std::make_shared<grpc::ClientContext>();
+        context->set_deadline(std::chrono::system_clock::now() + rpc_timeout_);
+        // Fail fast while the zone is down instead of waiting out the deadline
+        context->set_wait_for_ready(false);
+        return context;
+    }
+
+    void ZoneClient::StreamLoop()
+    {
+        Lanes::EnterLane(Lanes::Lane::TELEMETRY);
+        std::chrono::milliseconds backoff = kInitialBackoff;
+
+        // Ask for every sample the zone produces and never lose any to conflation
+        obd::FuelLevelStreamRequest request;
+        request.set_interval_seconds(static_cast<uint32_t>(stream_interval_.count()));
+        request.set_backpressure_policy(obd::BACKPRESSURE_DROP_OLDEST);
+
+        while (running_)
+        {
+            grpc::ClientContext context;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!running_) break;
+                stream_context_ = &context;
+            }
+
+            auto reader = obd_stub_->StreamFuelLevel(&context, request);
+            obd::FuelLevelResponse response;
+            while (reader->Read(&response))
+            {
+                if (!connected_)
+                {
+                    connected_ = true;
+                    backoff = kInitialBackoff;
+                    LOG_INFO("Zone {} stream connected", config_.name);
+                    on_state_(index_, true);
+                }
+
+                Streaming::FuelSample sample;
+                sample.level_percent = response.level_percent();
+                sample.timestamp_ms = response.timestamp_ms();
+                sample.zone = index_;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    latest_ = sample;
+                    has_latest_ = true;
+                }
+                on_sample_(sample);
+            }
+            grpc::Status status = reader->Finish();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stream_context_ = nullptr;
+            }
+            if (connected_)
+            {
+                connected_ = false;
+                on_state_(index_, false);
+            }
+            if (!running_) break;
+
+            LOG_WARNING("Zone {} stream ended ({}), retrying in {} ms", config_.name, status.error_message(),
+                        static_cast<long>(backoff.count()));
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait_for(lock, backoff, [this] { return !running_; });
+            backoff = std::min(backoff * 2, kMaxBackoff);
+        }
+    }
+
+} // namespace Aggregator
@@ -2,9 +2,52 @@
 #include "logger.hpp"
 #include <fstream>
 #include <filesystem>
+#include <sstream>
 
 namespace zonal_controller {
 
+namespace {
+
+void parseLane(const YAML::Node& node, LaneConfig& lane) {
+    if (node["threads"]) {
+        lane.threads = node["threads"].as<int>();
+    }
+    if (node["cpus"]) {
+        lane.cpus = node["cpus"].as<std::vector<int>>();
+    }
+    if (node["sched_fifo_priority"]) {
+        lane.schedFifoPriority = node["sched_fifo_priority"].as<int>();
+    }
+    if (node["nice"]) {
+        lane.nice = node["nice"].as<int>();
+    }
+}
+
+// ISO 3779: 17 characters, digits and capital letters other than I, O and Q
+bool isValidVin(const std::string& vin) {
+    constexpr std::size_t kVinLength = 17;
+    if (vin.size() != kVinLength) return false;
+    for (char c : vin) {
+        bool digit = c >= '0' && c <= '9';
+        bool letter = c >= 'A' && c <= 'Z' && c != 'I' && c != 'O' && c != 'Q';
+        if (!digit && !letter) return false;
+    }
+    return true;
+}
+
+// Classic CAN (11-bit) identifiers; the OBD-II server masks with CAN_SFF_MASK
+bool isValidCanId(int id) {
+    return id >= 0 && id <= 0x7FF;
+}
+
+std::string toHex(int value) {
+    std::ostringstream out;
+    out << std::uppercase << std::hex << value;
+    return out.str();
+}
+
+} // namespace
+
 bool Config::loadConfig(const std::string& configPath) {
     // Try to find the config file in multiple locations
     std::vector<std::string> possiblePaths = {
@@ -50,6 +93,174 @@ bool Config::loadConfig(const std::string& configPath) {
             }
         }
 
+        if (config["streaming"]) {
+            if (config["streaming"]["sample_interval_ms"]) {
+                streamSampleIntervalMs = config["streaming"]["sample_interval_ms"].as<int>();
+            }
+            if (config["streaming"]["queue_depth"]) {
+                streamQueueDepth = config["streaming"]["queue_depth"].as<int>();
+            }
+            if (config["streaming"]["max_queue_depth"]) {
+                streamMaxQueueDepth = config["streaming"]["max_queue_depth"].as<int>();
+            }
+            if (config["streaming"]["max_lag_ms"]) {
+                streamMaxLagMs = config["streaming"]["max_lag_ms"].as<int>();
+            }
+        }
+
+        if (config["aggregator"]) {
+            const YAML::Node& aggregator = config["aggregator"];
+            if (aggregator["enabled"]) {
+                aggregatorEnabled = aggregator["enabled"].as<bool>();
+            }
+            if (aggregator["reorder_window_ms"]) {
+                aggregatorReorderWindowMs = aggregator["reorder_window_ms"].as<int>();
+            }
+            if (aggregator["rpc_timeout_ms"]) {
+                aggregatorRpcTimeoutMs = aggregator["rpc_timeout_ms"].as<int>();
+            }
+            if (aggregator["zones"]) {
+                zones.clear();
+                for (const auto& node : aggregator["zones"]) {
+                    ZoneConfig zone;
+                    zone.name = node["name"].as<std::string>();
+                    zone.address = node["address"].as<std::string>();
+                    if (node["owns"]) {
+                        zone.owns = node["owns"].as<std::vector<std::string>>();
+                    }
+                    zones.push_back(zone);
+                }
+            }
+        }
+
+        if (config["lanes"]) {
+            const YAML::Node& lanes = config["lanes"];
+            if (lanes["control"]) {
+                parseLane(lanes["control"], controlLane);
+            }
+            if (lanes["telemetry"]) {
+                parseLane(lanes["telemetry"], telemetryLane);
+            }
+            if (lanes["report_interval_s"]) {
+                laneReportIntervalS = lanes["report_interval_s"].as<int>();
+            }
+        }
+
+        if (config["http"]) {
+            const YAML::Node& http = config["http"];
+            if (http["enabled"]) {
+                httpEnabled = http["enabled"].as<bool>();
+            }
+            if (http["address"]) {
+                httpAddress = http["address"].as<std::string>();
+            }
+            if (http["port"]) {
+                httpPort = http["port"].as<int>();
+            }
+            if (http["max_connections"]) {
+                httpMaxConnections = http["max_connections"].as<int>();
+            }
+            if (http["vehicle_id"]) {
+                vehicleId = http["vehicle_id"].as<std::string>();
+            }
+        }
+
+        if (config["rules"]) {
+            rules.clear();
+            for (const auto& node : config["rules"]) {
+                RuleConfig rule;
+                rule.id = node["id"].as<std::string>();
+                rule.condition = node["condition"].as<std::string>();
+                if (node["hysteresis"]) {
+                    rule.hysteresis = node["hysteresis"].as<double>();
+                }
+                if (node["debounce_ms"]) {
+                    rule.debounceMs = node["debounce_ms"].as<int>();
+                }
+                if (node["message"]) {
+                    rule.message = node["message"].as<std::string>();
+                }
+                rules.push_back(rule);
+            }
+        }
+
+        if (config["tracing"]) {
+            const YAML::Node& tracing = config["tracing"];
+            if (tracing["enabled"]) {
+                tracingEnabled = tracing["enabled"].as<bool>();
+            }
+            if (tracing["output_dir"]) {
+                tracingOutputDir = tracing["output_dir"].as<std::string>();
+            }
+            if (tracing["export_interval_ms"]) {
+                tracingExportIntervalMs = tracing["export_interval_ms"].as<int>();
+            }
+            if (tracing["buffer_spans"]) {
+                tracingBufferSpans = tracing["buffer_spans"].as<int>();
+            }
+            if (tracing["max_files"]) {
+                tracingMaxFiles = tracing["max_files"].as<int>();
+            }
+        }
+
+        if (config["diagnostics"]) {
+            const YAML::Node& diagnostics = config["diagnostics"];
+            if (diagnostics["sample_interval_ms"]) {
+                diagnosticsSampleIntervalMs = diagnostics["sample_interval_ms"].as<int>();
+            }
+            if (diagnostics["history"]) {
+                diagnosticsHistory = diagnostics["history"].as<int>();
+            }
+        }
+
+        if (config["obd2"]) {
+            const YAML::Node& obd2 = config["obd2"];
+            if (obd2["enabled"]) {
+                obd2Enabled = obd2["enabled"].as<bool>();
+            }
+            if (obd2["interface"]) {
+                obd2Interface = obd2["interface"].as<std::string>();
+            }
+            // Checked before they are stored, like the VIN, so a rejected file leaves the defaults
+            int requestId = obd2["request_id"] ? obd2["request_id"].as<int>() : obd2RequestId;
+            int functionalId = obd2["functional_id"] ? obd2["functional_id"].as<int>() : obd2FunctionalId;
+            int responseId = obd2["response_id"] ? obd2["response_id"].as<int>() : obd2ResponseId;
+            int paddingByte = obd2["padding_byte"] ? obd2["padding_byte"].as<int>() : obd2PaddingByte;
+            if (!isValidCanId(requestId) || !isValidCanId(functionalId) || !isValidCanId(responseId)) {
+                LOG_ERROR("Invalid obd2 identifiers 0x{}, 0x{}, 0x{}: expected 11-bit CAN identifiers (0x000-0x7FF)",
+                          toHex(requestId), toHex(functionalId), toHex(responseId));
+                return false;
+            }
+            if (requestId == functionalId || requestId == responseId || functionalId == responseId) {
+                LOG_ERROR("Invalid obd2 identifiers 0x{}, 0x{}, 0x{}: request, functional and response must differ",
+                          toHex(requestId), toHex(functionalId), toHex(responseId));
+                return false;
+            }
+            if (paddingByte < 0 || paddingByte > 0xFF) {
+                LOG_ERROR("Invalid obd2.padding_byte {}: expected 0x00-0xFF", paddingByte);
+                return false;
+            }
+            obd2RequestId = requestId;
+            obd2FunctionalId = functionalId;
+            obd2ResponseId = responseId;
+            obd2PaddingByte = paddingByte;
+            if (obd2["padding"]) {
+                obd2Padding = obd2["padding"].as<bool>();
+            }
+            if (obd2["ecu_name"]) {
+                obd2EcuName = obd2["ecu_name"].as<std::string>();
+            }
+            if (obd2["vin"]) {
+                std::string vin = obd2["vin"].as<std::string>();
+                if (!isValidVin(vin)) {
+                    LOG_ERROR("Invalid obd2.vin '{}': expected 17 digits and capital letters other than I, O and Q",
+                              vin);
+                    return false;
+                }
+                obd2Vin = vin;
+            }
+        }
+
         LOG_INFO("Configuration loaded successfully from {}", foundPath);
         return true;
     } catch (const YAML::Exception& e) {
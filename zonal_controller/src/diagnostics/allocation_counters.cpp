@@ -0,0 +1,137 @@
+#include "../include/diagnostics/allocation_counters.h"
+#include <atomic>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+namespace Diagnostics
+{
+    namespace
+    {
+        // Threads are spread over striped counters so allocation-heavy threads do not share a cache line
+        constexpr unsigned kStripes = 16;
+
+        struct alignas(64) Stripe
+        {
+            std::atomic<uint64_t> allocations{0};
+            std::atomic<uint64_t> frees{0};
+            std::atomic<uint64_t> allocated_bytes{0};
+            std::atomic<uint64_t> freed_bytes{0};
+        };
+
+        Stripe g_stripes[kStripes];
+        std::atomic<unsigned> g_next_stripe{0};
+        thread_local unsigned t_stripe = kStripes;
+
+        Stripe &LocalStripe()
+        {
+            if (t_stripe == kStripes)
+            {
+                t_stripe = g_next_stripe.fetch_add(1, std::memory_order_relaxed) % kStripes;
+            }
+            return g_stripes[t_stripe];
+        }
+
+        void *Allocate(std::size_t size) noexcept
+        {
+            void *ptr = std::malloc(size != 0 ? size : 1);
+            if (ptr)
+            {
+                Stripe &stripe = LocalStripe();
+                stripe.allocations.fetch_add(1, std::memory_order_relaxed);
+                stripe.allocated_bytes.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed);
+            }
+            return ptr;
+        }
+
+        void Free(void *ptr) noexcept
+        {
+            if (!ptr) return;
+            Stripe &stripe = LocalStripe();
+            stripe.frees.fetch_add(1, std::memory_order_relaxed);
+            stripe.freed_bytes.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed);
+            std::free(ptr);
+        }
+
+        void *AllocateOrThrow(std::size_t size)
+        {
+            for (;;)
+            {
+                if (void *ptr = Allocate(size)) return ptr;
+                std::new_handler handler = std::get_new_handler();
+                if (!handler) throw std::bad_alloc();
+                handler();
+            }
+        }
+    }
+
+    AllocationCounters ReadAllocationCounters()
+    {
+        AllocationCounters counters;
+        for (const Stripe &stripe : g_stripes)
+        {
+            counters.allocations += stripe.allocations.load(std::memory_order_relaxed);
+            counters.frees += stripe.frees.load(std::memory_order_relaxed);
+            counters.allocated_bytes += stripe.allocated_bytes.load(std::memory_order_relaxed);
+            counters.freed_bytes += stripe.freed_bytes.load(std::memory_order_relaxed);
+        }
+        return counters;
+    }
+
+    uint64_t HeapInUseBytes()
+    {
+        return mallinfo2().uordblks;
+    }
+
+} // namespace Diagnostics
+
+// Replacements for the global allocation functions; the aligned overloads keep their defaults
+void *operator new(std::size_t size)
+{
+    return Diagnostics::AllocateOrThrow(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return Diagnostics::AllocateOrThrow(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return Diagnostics::Allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return Diagnostics::Allocate(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    Diagnostics::Free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    Diagnostics::Free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    Diagnostics::Free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    Diagnostics::Free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+    Diagnostics::Free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+    Diagnostics::Free(ptr);
+}
@@ -0,0 +1,345 @@
+#include "../include/diagnostics/profiler.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <cxxabi.h>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <fstream>
+#include <linux/perf_event.h>
+#include <map>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include "../include/logger.hpp"
+
+namespace Diagnostics
+{
+    namespace
+    {
+        // Ring buffer per thread, drained every kDrainInterval during the capture
+        constexpr std::size_t kDataPages = 64;
+        constexpr std::chrono::milliseconds kDrainInterval(50);
+
+        struct ThreadEvent
+        {
+            int fd = -1;
+            uint32_t tid = 0;
+            std::string name;
+            void *base = MAP_FAILED;
+            std::size_t size = 0;
+        };
+
+        struct Aggregate
+        {
+            uint64_t samples = 0;
+            uint64_t lost = 0;
+            std::unordered_map<uint64_t, uint64_t> leaves;
+            std::map<std::vector<uint64_t>, uint64_t> stacks;  // Outermost frame first
+            std::unordered_map<uint32_t, uint64_t> threads;
+        };
+
+        std::vector<uint32_t> ListThreads()
+        {
+            std::vector<uint32_t> tids;
+            DIR *tasks = opendir("/proc/self/task");
+            if (!tasks) return tids;
+            while (dirent *entry = readdir(tasks))
+            {
+                if (entry->d_name[0] >= '0' && entry->d_name[0] <= '9')
+                {
+                    tids.push_back(static_cast<uint32_t>(std::strtoul(entry->d_name, nullptr, 10)));
+                }
+            }
+            closedir(tasks);
+            return tids;
+        }
+
+        std::string ThreadName(uint32_t tid)
+        {
+            std::ifstream comm("/proc/self/task/" + std::to_string(tid) + "/comm");
+            std::string name;
+            std::getline(comm, name);
+            return name + " (" + std::to_string(tid) + ")";
+        }
+
+        bool Open(ThreadEvent &event, int frequency_hz, int *error)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_SOFTWARE;
+            attr.config = PERF_COUNT_SW_CPU_CLOCK;
+            attr.freq = 1;
+            attr.sample_freq = static_cast<uint64_t>(frequency_hz);
+            attr.sample_type = PERF_SAMPLE_IP | PERF_SAMPLE_TID | PERF_SAMPLE_CALLCHAIN;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.exclude_callchain_kernel = 1;
+
+            event.fd = static_cast<int>(
+                syscall(SYS_perf_event_open, &attr, static_cast<pid_t>(event.tid), -1, -1, PERF_FLAG_FD_CLOEXEC));
+            if (event.fd < 0)
+            {
+                *error = errno;
+                return false;
+            }
+
+            event.size = (kDataPages + 1) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            event.base = mmap(nullptr, event.size, PROT_READ | PROT_WRITE, MAP_SHARED, event.fd, 0);
+            if (event.base == MAP_FAILED)
+            {
+                *error = errno;
+                close(event.fd);
+                event.fd = -1;
+                return false;
+            }
+            return true;
+        }
+
+        void Close(ThreadEvent &event)
+        {
+            if (event.base != MAP_FAILED) munmap(event.base, event.size);
+            if (event.fd >= 0) close(event.fd);
+        }
+
+        void Drain(ThreadEvent &event, Aggregate &aggregate, std::vector<char> &record)
+        {
+            auto *meta = static_cast<perf_event_mmap_page *>(event.base);
+            const char *data = static_cast<const char *>(event.base) + meta->data_offset;
+            const uint64_t data_size = meta->data_size;
+
+            uint64_t head = __atomic_load_n(&meta->data_head, __ATOMIC_ACQUIRE);
+            uint64_t tail = meta->data_tail;
+
+            // Records may wrap around the end of the ring, so copy each one out
+            auto copy = [&](uint64_t offset, void *out, std::size_t length) {
+                std::size_t start = offset % data_size;
+                std::size_t first = std::min<std::size_t>(length, data_size - start);
+                std::memcpy(out, data + start, first);
+                std::memcpy(static_cast<char *>(out) + first, data, length - first);
+            };
+
+            while (tail < head)
+            {
+                perf_event_header header;
+                copy(tail, &header, sizeof(header));
+                if (header.size < sizeof(header)) break;
+                record.resize(header.size);
+                copy(tail, record.data(), header.size);
+                tail += header.size;
+
+                const char *body = record.data() + sizeof(header);
+                if (header.type == PERF_RECORD_LOST)
+                {
+                    uint64_t fields[2];
+                    std::memcpy(fields, body, sizeof(fields));
+                    aggregate.lost += fields[1];
+                    continue;
+                }
+                if (header.type != PERF_RECORD_SAMPLE) continue;
+
+                // ip, pid/tid, nr, ips[nr]
+                uint64_t ip, nr;
+                uint32_t ids[2];
+                std::memcpy(&ip, body, sizeof(ip));
+                std::memcpy(ids, body + 8, sizeof(ids));
+                std::memcpy(&nr, body + 16, sizeof(nr));
+                nr = std::min<uint64_t>(nr, (header.size - sizeof(header) - 24) / sizeof(uint64_t));
+
+                std::vector<uint64_t> stack;
+                stack.reserve(nr);
+                for (uint64_t i = 0; i < nr; ++i)
+                {
+                    uint64_t frame;
+                    std::memcpy(&frame, body + 24 + i * sizeof(frame), sizeof(frame));
+                    if (frame >= PERF_CONTEXT_MAX) continue;  // Context marker, not an address
+                    stack.push_back(frame);
+                }
+                if (stack.empty()) stack.push_back(ip);
+                std::reverse(stack.begin(), stack.end());
+
+                ++aggregate.samples;
+                ++aggregate.leaves[ip];
+                ++aggregate.stacks[stack];
+                ++aggregate.threads[ids[1]];
+            }
+            __atomic_store_n(&meta->data_tail, tail, __ATOMIC_RELEASE);
+        }
+
+        /**
+         * @brief Resolve addresses to function names, caching the results
+         */
+        class Symbolizer
+        {
+        public:
+            /**
+             * @brief Name the function containing an address
+             *
+             * @return const std::string* Name, or nullptr if no loaded object contains the address
+             */
+            const std::string *Name(uint64_t address)
+            {
+                auto it = cache_.find(address);
+                if (it != cache_.end()) return it->second.empty() ? nullptr : &it->second;
+
+                std::string name;
+                Dl_info info{};
+                if (dladdr(reinterpret_cast<void *>(address), &info) && info.dli_sname)
+                {
+                    int status = 0;
+                    char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+                    name = status == 0 && demangled ? demangled : info.dli_sname;
+                    std::free(demangled);
+                }
+                else if (info.dli_fname && info.dli_fbase)
+                {
+                    const char *slash = std::strrchr(info.dli_fname, '/');
+                    char offset[32];
+                    std::snprintf(offset, sizeof(offset), "+0x%llx",
+                                  static_cast<unsigned long long>(address - reinterpret_cast<uint64_t>(info.dli_fbase)));
+                    name = std::string(slash ? slash + 1 : info.dli_fname) + offset;
+                }
+                auto &cached = cache_.emplace(address, std::move(name)).first->second;
+                return cached.empty() ? nullptr : &cached;
+            }
+
+            /**
+             * @brief Name the function containing an address, falling back to the raw address
+             */
+            std::string NameOrAddress(uint64_t address)
+            {
+                if (const std::string *name = Name(address)) return *name;
+                char raw[32];
+                std::snprintf(raw, sizeof(raw), "0x%llx", static_cast<unsigned long long>(address));
+                return raw;
+            }
+
+        private:
+            std::unordered_map<uint64_t, std::string> cache_;  // Empty = not in any loaded object
+        };
+
+        void KeepTop(std::unordered_map<std::string, uint64_t> &counts, std::size_t max_entries,
+                     std::vector<ProfileEntry> *out)
+        {
+            out->clear();
+            out->reserve(counts.size());
+            for (auto &entry : counts)
+            {
+                out->push_back({entry.first, entry.second});
+            }
+            std::sort(out->begin(), out->end(), [](const ProfileEntry &a, const ProfileEntry &b) {
+                return a.samples != b.samples ? a.samples > b.samples : a.name < b.name;
+            });
+            if (out->size() > max_entries) out->resize(max_entries);
+        }
+    }
+
+    CaptureStatus Profiler::capture(std::chrono::seconds duration, int frequency_hz, std::size_t max_entries,
+                           const std::function<bool()> &cancelled, ProfileResult *result, std::string *error)
+    {
+        if (busy_.exchange(true))
+        {
+            *error = "a profile capture is already running";
+            return CaptureStatus::BUSY;
+        }
+
+        std::vector<ThreadEvent> events;
+        int open_error = 0;
+        for (uint32_t tid : ListThreads())
+        {
+            ThreadEvent event;
+            event.tid = tid;
+            event.name = ThreadName(tid);
+            // Threads that exit between listing and opening are skipped
+            if (Open(event, frequency_hz, &open_error))
+            {
+                events.push_back(std::move(event));
+            }
+        }
+        if (events.empty())
+        {
+            *error = std::string("perf_event_open failed: ") + std::strerror(open_error) +
+                     " (check kernel.perf_event_paranoid)";
+            busy_ = false;
+            return CaptureStatus::FAILED;
+        }
+
+        LOG_INFO("Profiling {} threads for {} s at {} Hz", events.size(), static_cast<long>(duration.count()),
+                 frequency_hz);
+        for (auto &event : events)
+        {
+            ioctl(event.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+
+        Aggregate aggregate;
+        std::vector<char> record;
+        auto deadline = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < deadline && !cancelled())
+        {
+            std::this_thread::sleep_for(kDrainInterval);
+            for (auto &event : events)
+            {
+                Drain(event, aggregate, record);
+            }
+        }
+
+        for (auto &event : events)
+        {
+            ioctl(event.fd, PERF_EVENT_IOC_DISABLE, 0);
+            Drain(event, aggregate, record);
+        }
+
+        // Symbolize; frames other than the leaf are return addresses, so look up the call itself
+        Symbolizer symbols;
+        std::unordered_map<std::string, uint64_t> functions;
+        for (const auto &leaf : aggregate.leaves)
+        {
+            functions[symbols.NameOrAddress(leaf.first)] += leaf.second;
+        }
+        std::unordered_map<std::string, uint64_t> stacks;
+        std::string folded;
+        for (const auto &stack : aggregate.stacks)
+        {
+            // Frame-pointer unwinding through code built without them yields junk outer
+            // frames, so keep only the frames up to the first one outside any loaded object
+            const std::vector<uint64_t> &frames = stack.first;
+            std::size_t outermost = frames.size() - 1;
+            while (outermost > 0 && symbols.Name(frames[outermost - 1] - 1))
+            {
+                --outermost;
+            }
+
+            folded.clear();
+            for (std::size_t i = outermost; i < frames.size(); ++i)
+            {
+                if (i > outermost) folded += ';';
+                bool leaf = i + 1 == frames.size();
+                folded += symbols.NameOrAddress(leaf ? frames[i] : frames[i] - 1);
+            }
+            stacks[folded] += stack.second;
+        }
+        std::unordered_map<std::string, uint64_t> threads;
+        for (auto &event : events)
+        {
+            auto it = aggregate.threads.find(event.tid);
+            if (it != aggregate.threads.end()) threads[event.name] = it->second;
+            Close(event);
+        }
+
+        result->samples = aggregate.samples;
+        result->lost = aggregate.lost;
+        KeepTop(functions, max_entries, &result->functions);
+        KeepTop(stacks, max_entries, &result->stacks);
+        KeepTop(threads, max_entries, &result->threads);
+        LOG_INFO("Profile captured: {} samples, {} lost", aggregate.samples, aggregate.lost);
+
+        busy_ = false;
+        return CaptureStatus::OK;
+    }
+
+} // namespace Diagnostics
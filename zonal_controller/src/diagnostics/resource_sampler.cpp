@@ -0,0 +1,211 @@
+#include "../include/diagnostics/resource_sampler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <unistd.h>
+#include "../include/logger.hpp"
+
+namespace Diagnostics
+{
+    namespace
+    {
+        uint64_t NowMs()
+        {
+            auto now = std::chrono::system_clock::now();
+            return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+        }
+
+        // Reads a small /proc file into buf; returns the length, or 0 on failure
+        std::size_t ReadProcFile(const char *path, char *buf, std::size_t size)
+        {
+            FILE *file = std::fopen(path, "r");
+            if (!file) return 0;
+            std::size_t length = std::fread(buf, 1, size - 1, file);
+            std::fclose(file);
+            buf[length] = '\0';
+            return length;
+        }
+
+        /**
+         * @brief Parse utime + stime (in clock ticks) and the name from a stat file
+         *
+         * The name sits in parentheses and may itself contain spaces or
+         * parentheses, so fields are counted from the last ')'.
+         */
+        bool ReadStat(const char *path, std::string *name, uint64_t *ticks)
+        {
+            char buf[1024];
+            if (ReadProcFile(path, buf, sizeof(buf)) == 0) return false;
+
+            char *open = std::strchr(buf, '(');
+            char *close = std::strrchr(buf, ')');
+            if (!open || !close || close < open) return false;
+            if (name) name->assign(open + 1, close);
+
+            // Fields after the name: state ppid pgrp session tty_nr tpgid flags
+            // minflt cminflt majflt cmajflt utime stime
+            char *cursor = close + 1;
+            uint64_t fields[13];
+            for (uint64_t &field : fields)
+            {
+                while (*cursor == ' ') ++cursor;
+                if (*cursor == '\0') return false;
+                field = std::strtoull(cursor, &cursor, 10);
+                while (*cursor != ' ' && *cursor != '\0') ++cursor;
+            }
+            *ticks = fields[11] + fields[12];
+            return true;
+        }
+    }
+
+    ResourceSampler::ResourceSampler(std::chrono::milliseconds interval, std::size_t history, SamplerSources sources)
+        : interval_(interval), sources_(sources), page_size_(sysconf(_SC_PAGESIZE)), ring_(std::max<std::size_t>(1, history))
+    {
+        last_time_ = std::chrono::steady_clock::now();
+        ReadStat("/proc/self/stat", nullptr, &last_process_ticks_);
+        SampleThreads(scratch_, 0.0);  // Baseline so the first sample covers one interval
+        thread_ = std::thread(&ResourceSampler::Run, this);
+        LOG_INFO("Resource sampler started: every {} ms, {} samples kept", static_cast<long>(interval_.count()),
+                 ring_.size());
+    }
+
+    ResourceSampler::~ResourceSampler()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    std::vector<ResourceSample> ResourceSampler::recent(std::size_t max_samples) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::size_t count = max_samples == 0 ? count_ : std::min(max_samples, count_);
+        std::vector<ResourceSample> samples;
+        samples.reserve(count);
+        for (std::size_t i = count_ - count; i < count_; ++i)
+        {
+            samples.push_back(ring_[(head_ + i) % ring_.size()]);
+        }
+        return samples;
+    }
+
+    void ResourceSampler::Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!cv_.wait_for(lock, interval_, [this] { return !running_; }))
+        {
+            lock.unlock();
+            Sample(scratch_);
+            lock.lock();
+
+            // Swap into the slot so the evicted sample's buffers are reused next time
+            if (count_ == ring_.size())
+            {
+                std::swap(ring_[head_], scratch_);
+                head_ = (head_ + 1) % ring_.size();
+            }
+            else
+            {
+                std::swap(ring_[(head_ + count_) % ring_.size()], scratch_);
+                ++count_;
+            }
+        }
+    }
+
+    void ResourceSampler::Sample(ResourceSample &sample)
+    {
+        auto now = std::chrono::steady_clock::now();
+        double elapsed_ticks = std::chrono::duration<double>(now - last_time_).count() * sysconf(_SC_CLK_TCK);
+        last_time_ = now;
+        sample.timestamp_ms = NowMs();
+
+        uint64_t process_ticks = 0;
+        if (ReadStat("/proc/self/stat", nullptr, &process_ticks) && elapsed_ticks > 0)
+        {
+            sample.cpu_percent = 100.0 * static_cast<double>(process_ticks - last_process_ticks_) / elapsed_ticks;
+            last_process_ticks_ = process_ticks;
+        }
+
+        char statm[256];
+        unsigned long long vm_pages = 0, rss_pages = 0;
+        if (ReadProcFile("/proc/self/statm", statm, sizeof(statm)) > 0 &&
+            std::sscanf(statm, "%llu %llu", &vm_pages, &rss_pages) == 2)
+        {
+            sample.vm_bytes = vm_pages * page_size_;
+            sample.rss_bytes = rss_pages * page_size_;
+        }
+
+        sample.heap_in_use_bytes = HeapInUseBytes();
+        sample.allocations = ReadAllocationCounters();
+        sample.logger_backlog = zonal_controller::Logger::getInstance().backlog();
+
+        sample.queues.clear();
+        sample.fuel_subscribers = 0;
+        if (sources_.publisher)
+        {
+            for (const auto &subscriber : sources_.publisher->stats())
+            {
+                sample.queues.push_back({"fuel_subscriber/" + std::to_string(subscriber.id), subscriber.queue.depth,
+                                         subscriber.queue.capacity, subscriber.queue.dropped});
+            }
+            sample.fuel_subscribers = sample.queues.size();
+        }
+        sample.rule_watchers = 0;
+        if (sources_.rules)
+        {
+            for (const auto &watcher : sources_.rules->watcher_stats())
+            {
+                sample.queues.push_back({"rule_watcher/" + std::to_string(watcher.id), watcher.queue.depth,
+                                         watcher.queue.capacity, watcher.queue.dropped});
+                ++sample.rule_watchers;
+            }
+        }
+        sample.http_streams = sources_.http ? sources_.http->stream_count() : 0;
+
+        SampleThreads(sample, elapsed_ticks);
+    }
+
+    void ResourceSampler::SampleThreads(ResourceSample &sample, double elapsed_ticks)
+    {
+        const double ms_per_tick = 1000.0 / sysconf(_SC_CLK_TCK);
+        std::size_t count = 0;
+        thread_ticks_.clear();
+
+        DIR *tasks = opendir("/proc/self/task");
+        if (!tasks)
+        {
+            sample.threads.clear();
+            return;
+        }
+        while (dirent *entry = readdir(tasks))
+        {
+            if (entry->d_name[0] < '0' || entry->d_name[0] > '9') continue;
+
+            char path[300];
+            std::snprintf(path, sizeof(path), "/proc/self/task/%s/stat", entry->d_name);
+            if (count == sample.threads.size()) sample.threads.emplace_back();
+            ThreadUsage &thread = sample.threads[count];
+            uint64_t ticks = 0;
+            if (!ReadStat(path, &thread.name, &ticks)) continue;
+
+            thread.tid = static_cast<uint32_t>(std::strtoul(entry->d_name, nullptr, 10));
+            thread.cpu_time_ms = static_cast<uint64_t>(ticks * ms_per_tick);
+            // A thread first seen in this interval is charged from its start
+            auto last = last_thread_ticks_.find(thread.tid);
+            uint64_t previous = last != last_thread_ticks_.end() && last->second <= ticks ? last->second : 0;
+            thread.cpu_percent = elapsed_ticks > 0 ? 100.0 * static_cast<double>(ticks - previous) / elapsed_ticks : 0.0;
+            thread_ticks_[thread.tid] = ticks;
+            ++count;
+        }
+        closedir(tasks);
+
+        sample.threads.resize(count);
+        std::swap(last_thread_ticks_, thread_ticks_);
+    }
+
+} // namespace Diagnostics
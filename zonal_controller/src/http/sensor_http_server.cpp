@@ -0,0 +1,652 @@
+#include "../include/http/sensor_http_server.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../include/lanes/execution_lane.h"
+#include "../include/logger.hpp"
+#include "../include/tracing/span.h"
+
+namespace Http
+{
+    namespace
+    {
+        constexpr uint64_t kListenToken = UINT64_MAX;
+        constexpr uint64_t kWakeToken = UINT64_MAX - 1;
+        constexpr uint64_t kSampleToken = UINT64_MAX - 2;
+
+        // Connection tokens hold the slot in the low half and its generation in the high half
+        constexpr uint64_t kSlotMask = UINT32_MAX;
+        constexpr int kGenerationShift = 32;
+
+        constexpr std::string_view kFuelLevelPath = "/api/v1/vehicle/data/fuel_level";
+        constexpr std::string_view kFuelStreamPath = "/api/v1/vehicle/stream/fuel_level";
+
+        // Same defaults as the signal service gateway
+        constexpr int kDefaultIntervalSeconds = 2;
+        constexpr uint64_t kDefaultMaxUpdates = 10;
+
+        // Longer X-Request-ID values are cut so the escaped snapshot still fits the JSON buffer
+        constexpr std::size_t kMaxRequestIdSize = 64;
+
+        // Comment line sent on idle streams so proxies keep them open
+        constexpr std::chrono::seconds kKeepaliveInterval(15);
+        constexpr std::string_view kKeepalive = ": keepalive\n\n";
+
+        constexpr std::string_view kStreamHeader =
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/event-stream\r\n"
+            "Cache-Control: no-cache\r\n"
+            "Connection: keep-alive\r\n"
+            "Access-Control-Allow-Origin: *\r\n"
+            "\r\n";
+
+        // How often the feeder re-checks for shutdown while no samples arrive
+        constexpr std::chrono::milliseconds kFeedPollInterval(200);
+        constexpr std::size_t kFeedQueueDepth = 64;
+
+        int64_t UnixSeconds()
+        {
+            return std::chrono::duration_cast<std::chrono::seconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                .count();
+        }
+
+        bool EqualsIgnoreCase(std::string_view a, std::string_view b)
+        {
+            return a.size() == b.size() &&
+                   std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+                       return std::tolower(static_cast<unsigned char>(x)) ==
+                              std::tolower(static_cast<unsigned char>(y));
+                   });
+        }
+
+        std::string_view HeaderValue(std::string_view headers, std::string_view name)
+        {
+            while (!headers.empty()) {
+                std::size_t end = headers.find("\r\n");
+                std::string_view line = headers.substr(0, end);
+                std::size_t colon = line.find(':');
+                if (colon != std::string_view::npos && EqualsIgnoreCase(line.substr(0, colon), name)) {
+                    std::string_view value = line.substr(colon + 1);
+                    while (!value.empty() && value.front() == ' ') value.remove_prefix(1);
+                    return value;
+                }
+                if (end == std::string_view::npos) break;
+                headers.remove_prefix(end + 2);
+            }
+            return {};
+        }
+
+        // Returns the value of a positive integer query parameter, or fallback if absent or invalid
+        template <typename T>
+        T QueryInt(std::string_view query, std::string_view name, T fallback)
+        {
+            while (!query.empty()) {
+                std::size_t end = query.find('&');
+                std::string_view pair = query.substr(0, end);
+                std::size_t eq = pair.find('=');
+                if (eq != std::string_view::npos && pair.substr(0, eq) == name) {
+                    std::string_view text = pair.substr(eq + 1);
+                    T value{};
+                    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+                    if (result.ec == std::errc() && result.ptr == text.data() + text.size()) {
+                        return value;
+                    }
+                    return fallback;
+                }
+                if (end == std::string_view::npos) break;
+                query.remove_prefix(end + 1);
+            }
+            return fallback;
+        }
+    }
+
+    SensorHttpServer::SensorHttpServer(const HttpServerOptions &options, Streaming::FuelLevelPublisher &publisher,
+                                       std::vector<std::string> zone_names)
+        : options_(options), publisher_(publisher), zone_names_(std::move(zone_names))
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(options_.port));
+        if (inet_pton(AF_INET, options_.address.c_str(), &addr.sin_addr) != 1) {
+            throw std::runtime_error("Invalid HTTP listen address " + options_.address);
+        }
+
+        listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int reuse = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (listen_fd_ < 0 || bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+            listen(listen_fd_, SOMAXCONN) != 0) {
+            std::string error = std::strerror(errno);
+            if (listen_fd_ >= 0) close(listen_fd_);
+            throw std::runtime_error("Failed to listen for HTTP on " + options_.address + ":" +
+                                     std::to_string(options_.port) + ": " + error);
+        }
+
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (pipe2(sample_pipe_, O_NONBLOCK | O_CLOEXEC) != 0) {
+            throw std::runtime_error(std::string("Failed to create HTTP sample pipe: ") + std::strerror(errno));
+        }
+
+        for (auto [fd, token] : {std::pair<int, uint64_t>{listen_fd_, kListenToken},
+                                 {wake_fd_, kWakeToken},
+                                 {sample_pipe_[0], kSampleToken}}) {
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u64 = token;
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+        }
+
+        // Reserve every connection slot and buffer up front
+        connections_.resize(std::max<std::size_t>(1, options_.max_connections));
+        free_slots_.reserve(connections_.size());
+        for (std::size_t i = connections_.size(); i-- > 0;) {
+            connections_[i].in = std::make_unique<char[]>(kRequestBufferSize);
+            connections_[i].out = std::make_unique<char[]>(kResponseBufferSize);
+            connections_[i].next_due.reserve(std::max<std::size_t>(1, zone_names_.size()));
+            free_slots_.push_back(i);
+        }
+
+        // Keep every sample; the loop decimates per stream
+        Streaming::SubscriptionOptions feed;
+        feed.policy = Streaming::OverflowPolicy::DROP_OLDEST;
+        feed.queue_depth = kFeedQueueDepth;
+        feed.interval = std::chrono::milliseconds(0);
+        feeder_subscription_ = publisher_.subscribe(feed);
+
+        feeder_thread_ = std::thread(&SensorHttpServer::FeedLoop, this);
+        loop_thread_ = std::thread(&SensorHttpServer::EventLoop, this);
+        LOG_INFO("HTTP endpoint listening on {}:{}", options_.address, options_.port);
+    }
+
+    SensorHttpServer::~SensorHttpServer()
+    {
+        running_ = false;
+        publisher_.unsubscribe(feeder_subscription_.id);
+        uint64_t one = 1;
+        if (write(wake_fd_, &one, sizeof(one)) < 0) {
+            LOG_WARNING("Failed to wake HTTP loop: {}", std::strerror(errno));
+        }
+        if (feeder_thread_.joinable()) feeder_thread_.join();
+        if (loop_thread_.joinable()) loop_thread_.join();
+
+        for (auto &connection : connections_) {
+            if (connection.state != ConnectionState::FREE) Close(connection);
+        }
+        for (int fd : {listen_fd_, epoll_fd_, wake_fd_, sample_pipe_[0], sample_pipe_[1]}) {
+            if (fd >= 0) close(fd);
+        }
+        LOG_INFO("HTTP endpoint stopped");
+    }
+
+    void SensorHttpServer::FeedLoop()
+    {
+        Lanes::EnterLane(Lanes::Lane::TELEMETRY);
+        Streaming::FuelSample sample;
+        uint64_t dropped = 0;
+        while (running_) {
+            auto result = feeder_subscription_.queue->pop(sample, kFeedPollInterval);
+            if (result == Streaming::PopResult::CLOSED) break;
+            if (result != Streaming::PopResult::ITEM) continue;
+
+            // Writes smaller than PIPE_BUF are atomic, so the loop always reads whole samples
+            if (write(sample_pipe_[1], &sample, sizeof(sample)) < 0 && ++dropped % 100 == 1) {
+                LOG_WARNING("HTTP loop is not keeping up, {} samples dropped", dropped);
+            }
+        }
+    }
+
+    void SensorHttpServer::EventLoop()
+    {
+        Lanes::EnterLane(Lanes::Lane::TELEMETRY);
+        constexpr int kMaxEvents = 64;
+        epoll_event events[kMaxEvents];
+
+        while (running_) {
+            int count = epoll_wait(epoll_fd_, events, kMaxEvents, 1000);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                LOG_ERROR("HTTP epoll_wait failed: {}", std::strerror(errno));
+                break;
+            }
+
+            for (int i = 0; i < count; ++i) {
+                uint64_t token = events[i].data.u64;
+                if (token == kWakeToken) {
+                    return;
+                }
+                if (token == kListenToken) {
+                    Accept();
+                    continue;
+                }
+                if (token == kSampleToken) {
+                    Streaming::FuelSample samples[32];
+                    ssize_t bytes;
+                    while ((bytes = read(sample_pipe_[0], samples, sizeof(samples))) > 0) {
+                        for (std::size_t n = 0; n < static_cast<std::size_t>(bytes) / sizeof(samples[0]); ++n) {
+                            OnSample(samples[n]);
+                        }
+                    }
+                    continue;
+                }
+
+                // The slot may have been closed, or closed and reused, earlier in this batch
+                Connection &connection = connections_[token & kSlotMask];
+                if (connection.state == ConnectionState::FREE ||
+                    connection.generation != static_cast<uint32_t>(token >> kGenerationShift)) {
+                    continue;
+                }
+                if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                    Close(connection);
+                    continue;
+                }
+                if (events[i].events & EPOLLIN) OnReadable(connection);
+                if (connection.state != ConnectionState::FREE && (events[i].events & EPOLLOUT)) {
+                    OnWritable(connection);
+                }
+            }
+
+            SendKeepalives(std::chrono::steady_clock::now());
+        }
+    }
+
+    void SensorHttpServer::Accept()
+    {
+        while (true) {
+            int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    LOG_WARNING("HTTP accept failed: {}", std::strerror(errno));
+                }
+                return;
+            }
+
+            if (free_slots_.empty()) {
+                LOG_WARNING("HTTP connection refused: all {} slots in use", connections_.size());
+                close(fd);
+                continue;
+            }
+
+            // Small event writes should leave immediately rather than wait for more data
+            int nodelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+            std::size_t slot = free_slots_.back();
+            free_slots_.pop_back();
+            Connection &connection = connections_[slot];
+            connection.fd = fd;
+            connection.state = ConnectionState::READING;
+            connection.keep_alive = false;
+            connection.in_size = 0;
+            connection.out_begin = connection.out_end = 0;
+
+            epoll_event event{};
+            event.events = EPOLLIN | EPOLLRDHUP;
+            event.data.u64 = EventToken(connection);
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+        }
+    }
+
+    void SensorHttpServer::OnReadable(Connection &connection)
+    {
+        while (true) {
+            if (connection.in_size == kRequestBufferSize) {
+                if (connection.state != ConnectionState::READING) {
+                    // Nothing is parsed until the current response is out; streams ignore input
+                    if (connection.state == ConnectionState::STREAMING) connection.in_size = 0;
+                    else break;
+                } else {
+                    connection.keep_alive = false;
+                    Respond(connection, 431, "Request Header Fields Too Large",
+                            R"({"status":"error","message":"request header too large"})");
+                    AfterWrite(connection);
+                    return;
+                }
+            }
+
+            ssize_t bytes = recv(connection.fd, connection.in.get() + connection.in_size,
+                                 kRequestBufferSize - connection.in_size, 0);
+            if (bytes == 0) {
+                Close(connection);
+                return;
+            }
+            if (bytes < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    Close(connection);
+                    return;
+                }
+                break;
+            }
+            connection.in_size += static_cast<std::size_t>(bytes);
+        }
+
+        if (connection.state == ConnectionState::READING) ProcessRequests(connection);
+    }
+
+    void SensorHttpServer::ProcessRequests(Connection &connection)
+    {
+        while (connection.state == ConnectionState::READING) {
+            std::string_view buffer(connection.in.get(), connection.in_size);
+            std::size_t end = buffer.find("\r\n\r\n");
+            if (end == std::string_view::npos) break;
+
+            HandleRequest(connection, buffer.substr(0, end + 2));
+            if (connection.state == ConnectionState::FREE) return;
+
+            // Keep any pipelined bytes for the next request
+            std::size_t consumed = end + 4;
+            std::memmove(connection.in.get(), connection.in.get() + consumed, connection.in_size - consumed);
+            connection.in_size -= consumed;
+
+            if (connection.state == ConnectionState::WRITING && connection.out_begin == connection.out_end) {
+                if (!connection.keep_alive) {
+                    Close(connection);
+                    return;
+                }
+                connection.state = ConnectionState::READING;
+            }
+        }
+        UpdateInterest(connection);
+    }
+
+    void SensorHttpServer::OnWritable(Connection &connection)
+    {
+        if (Flush(connection)) AfterWrite(connection);
+    }
+
+    void SensorHttpServer::AfterWrite(Connection &connection)
+    {
+        if (connection.state == ConnectionState::FREE) return;
+        if (connection.state == ConnectionState::WRITING && connection.out_begin == connection.out_end) {
+            if (!connection.keep_alive) {
+                Close(connection);
+                return;
+            }
+            connection.state = ConnectionState::READING;
+            ProcessRequests(connection);
+            return;
+        }
+        UpdateInterest(connection);
+    }
+
+    void SensorHttpServer::HandleRequest(Connection &connection, std::string_view request)
+    {
+        TRACE_SPAN("SensorHttpServer.request");
+        std::size_t line_end = request.find("\r\n");
+        std::string_view line = request.substr(0, line_end);
+        std::string_view headers = request.substr(line_end + 2);
+
+        std::size_t first_space = line.find(' ');
+        std::size_t second_space = line.find(' ', first_space + 1);
+        if (first_space == std::string_view::npos || second_space == std::string_view::npos) {
+            connection.keep_alive = false;
+            Respond(connection, 400, "Bad Request", R"({"status":"error","message":"malformed request line"})");
+            return;
+        }
+        std::string_view method = line.substr(0, first_space);
+        std::string_view target = line.substr(first_space + 1, second_space - first_space - 1);
+        std::string_view version = line.substr(second_space + 1);
+
+        std::string_view connection_header = HeaderValue(headers, "Connection");
+        connection.keep_alive = version == "HTTP/1.1" ? !EqualsIgnoreCase(connection_header, "close")
+                                                      : EqualsIgnoreCase(connection_header, "keep-alive");
+
+        std::size_t question = target.find('?');
+        std::string_view path = target.substr(0, question);
+        std::string_view query = question == std::string_view::npos ? std::string_view() : target.substr(question + 1);
+
+        if (path != kFuelLevelPath && path != kFuelStreamPath) {
+            Respond(connection, 404, "Not Found", R"({"status":"error","message":"not found"})");
+            return;
+        }
+        if (method != "GET") {
+            // Any request body is left unread, so this connection cannot be reused
+            connection.keep_alive = false;
+            Respond(connection, 405, "Method Not Allowed", R"({"status":"error","message":"method not allowed"})");
+            return;
+        }
+
+        if (path == kFuelStreamPath) {
+            StartStream(connection, query);
+            return;
+        }
+
+        Streaming::FuelSample sample = publisher_.latest();
+        if (sample.timestamp_ms == 0) {
+            Respond(connection, 503, "Service Unavailable",
+                    R"({"status":"error","message":"no fuel level sample yet"})");
+            return;
+        }
+        std::string_view request_id = HeaderValue(headers, "X-Request-ID");
+        while (!request_id.empty() && request_id.back() == ' ') request_id.remove_suffix(1);
+        EncodeSample(sample, false, request_id.substr(0, kMaxRequestIdSize));
+        Respond(connection, 200, "OK", json_.view());
+    }
+
+    void SensorHttpServer::StartStream(Connection &connection, std::string_view query)
+    {
+        int interval_seconds = QueryInt<int>(query, "interval", kDefaultIntervalSeconds);
+        if (interval_seconds <= 0) interval_seconds = kDefaultIntervalSeconds;
+        // As in the gateway, a missing, zero or invalid max_updates falls back to the default
+        connection.remaining = QueryInt<uint64_t>(query, "max_updates", kDefaultMaxUpdates);
+        if (connection.remaining == 0) connection.remaining = kDefaultMaxUpdates;
+        connection.interval = std::chrono::seconds(interval_seconds);
+        connection.next_due.clear();
+        connection.skipped = 0;
+        connection.state = ConnectionState::STREAMING;
+        open_streams_.fetch_add(1, std::memory_order_relaxed);
+        connection.last_write = std::chrono::steady_clock::now();
+        Enqueue(connection, kStreamHeader);
+        LOG_INFO("HTTP fuel level stream started (interval {} s, max updates {})", interval_seconds,
+                 connection.remaining);
+
+        // Start with the cached sample so the client does not wait a full interval
+        Streaming::FuelSample sample = publisher_.latest();
+        if (sample.timestamp_ms != 0) {
+            auto now = std::chrono::steady_clock::now();
+            connection.next_due.resize(sample.zone + 1, now);
+            connection.next_due[sample.zone] = now + connection.interval;
+            EncodeSample(sample, true);
+            Enqueue(connection, std::string_view(event_.data(), event_size_));
+            if (--connection.remaining == 0) {
+                connection.state = ConnectionState::WRITING;
+                connection.keep_alive = false;
+                open_streams_.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+        Flush(connection);
+    }
+
+    void SensorHttpServer::OnSample(const Streaming::FuelSample &sample)
+    {
+        TRACE_SPAN("SensorHttpServer.fanout");
+        auto now = std::chrono::steady_clock::now();
+        bool encoded = false;
+
+        for (auto &connection : connections_) {
+            if (connection.state != ConnectionState::STREAMING) continue;
+
+            if (sample.zone >= connection.next_due.size()) {
+                connection.next_due.resize(sample.zone + 1, now);
+            }
+            // Allow some jitter so an interval that is a multiple of the sample period does not slip
+            auto &next_due = connection.next_due[sample.zone];
+            if (next_due > now + connection.interval / 4) continue;
+            next_due += connection.interval;
+            if (next_due <= now) next_due = now + connection.interval;
+
+            // Every stream gets the same bytes, so encode once per sample
+            if (!encoded) {
+                EncodeSample(sample, true);
+                encoded = true;
+            }
+            if (!Enqueue(connection, std::string_view(event_.data(), event_size_))) {
+                if (connection.skipped++ % 100 == 0) {
+                    LOG_WARNING("HTTP stream client is not keeping up, {} events skipped", connection.skipped);
+                }
+                continue;
+            }
+            connection.last_write = now;
+
+            if (--connection.remaining == 0) {
+                // Last update: close once it has been sent
+                connection.state = ConnectionState::WRITING;
+                connection.keep_alive = false;
+                open_streams_.fetch_sub(1, std::memory_order_relaxed);
+            }
+            if (Flush(connection)) AfterWrite(connection);
+        }
+    }
+
+    void SensorHttpServer::SendKeepalives(std::chrono::steady_clock::time_point now)
+    {
+        for (auto &connection : connections_) {
+            if (connection.state != ConnectionState::STREAMING) continue;
+            if (now - connection.last_write < kKeepaliveInterval) continue;
+            connection.last_write = now;
+            if (Enqueue(connection, kKeepalive) && Flush(connection)) AfterWrite(connection);
+        }
+    }
+
+    void SensorHttpServer::EncodeSample(const Streaming::FuelSample &sample, bool as_event,
+                                        std::string_view request_id)
+    {
+        TRACE_SPAN("SensorHttpServer.encode");
+        json_.clear();
+        json_.begin_object();
+        if (as_event) {
+            json_.field("event", "fuel_level_update");
+            json_.field("vehicle_id", options_.vehicle_id);
+        } else {
+            json_.field("status", "success");
+            json_.field("vehicle_id", options_.vehicle_id);
+            json_.field("data_key", "fuel_level");
+        }
+        json_.begin_object("data");
+        json_.field("level_percent", sample.level_percent);
+        json_.field("timestamp_ms", sample.timestamp_ms);
+        json_.field("status", int32_t(0));
+        if (sample.zone < zone_names_.size()) {
+            json_.field("source_zone", zone_names_[sample.zone]);
+        }
+        json_.end_object();
+        json_.field("timestamp", UnixSeconds());
+        if (!as_event) {
+            json_.field("request_id", request_id);
+        }
+        json_.end_object();
+
+        if (!json_.ok()) {
+            LOG_ERROR("HTTP payload exceeded {} bytes", kJsonBufferSize);
+        }
+        if (!as_event) return;
+
+        constexpr std::string_view kPrefix = "data: ";
+        std::string_view json = json_.view();
+        std::memcpy(event_.data(), kPrefix.data(), kPrefix.size());
+        std::memcpy(event_.data() + kPrefix.size(), json.data(), json.size());
+        event_size_ = kPrefix.size() + json.size();
+        event_[event_size_++] = '\n';
+        event_[event_size_++] = '\n';
+    }
+
+    void SensorHttpServer::Respond(Connection &connection, int status, std::string_view reason, std::string_view body)
+    {
+        char header[256];
+        int size = std::snprintf(header, sizeof(header),
+                                 "HTTP/1.1 %d %.*s\r\n"
+                                 "Content-Type: application/json\r\n"
+                                 "Content-Length: %zu\r\n"
+                                 "Connection: %s\r\n"
+                                 "Access-Control-Allow-Origin: *\r\n"
+                                 "\r\n",
+                                 status, static_cast<int>(reason.size()), reason.data(), body.size(),
+                                 connection.keep_alive ? "keep-alive" : "close");
+
+        connection.state = ConnectionState::WRITING;
+        Enqueue(connection, std::string_view(header, static_cast<std::size_t>(size)));
+        Enqueue(connection, body);
+        Flush(connection);
+    }
+
+    bool SensorHttpServer::Enqueue(Connection &connection, std::string_view data)
+    {
+        std::size_t pending = connection.out_end - connection.out_begin;
+        if (data.size() > kResponseBufferSize - pending) return false;
+
+        if (data.size() > kResponseBufferSize - connection.out_end) {
+            std::memmove(connection.out.get(), connection.out.get() + connection.out_begin, pending);
+            connection.out_begin = 0;
+            connection.out_end = pending;
+        }
+        std::memcpy(connection.out.get() + connection.out_end, data.data(), data.size());
+        connection.out_end += data.size();
+        return true;
+    }
+
+    bool SensorHttpServer::Flush(Connection &connection)
+    {
+        while (connection.out_begin < connection.out_end) {
+            ssize_t bytes = send(connection.fd, connection.out.get() + connection.out_begin,
+                                 connection.out_end - connection.out_begin, MSG_NOSIGNAL);
+            if (bytes < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+                Close(connection);
+                return false;
+            }
+            connection.out_begin += static_cast<std::size_t>(bytes);
+        }
+        connection.out_begin = connection.out_end = 0;
+        return true;
+    }
+
+    uint64_t SensorHttpServer::EventToken(const Connection &connection) const
+    {
+        auto slot = static_cast<uint64_t>(&connection - connections_.data());
+        return (static_cast<uint64_t>(connection.generation) << kGenerationShift) | slot;
+    }
+
+    void SensorHttpServer::UpdateInterest(Connection &connection)
+    {
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        if (connection.out_begin != connection.out_end) event.events |= EPOLLOUT;
+        event.data.u64 = EventToken(connection);
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection.fd, &event);
+    }
+
+    void SensorHttpServer::Close(Connection &connection)
+    {
+        if (connection.state == ConnectionState::STREAMING) {
+            open_streams_.fetch_sub(1, std::memory_order_relaxed);
+            if (connection.skipped > 0) {
+                LOG_INFO("HTTP stream closed after skipping {} events", connection.skipped);
+            }
+        }
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, connection.fd, nullptr);
+        close(connection.fd);
+        connection.fd = -1;
+        ++connection.generation;
+        connection.state = ConnectionState::FREE;
+        connection.in_size = 0;
+        connection.out_begin = connection.out_end = 0;
+        free_slots_.push_back(static_cast<std::size_t>(&connection - connections_.data()));
+    }
+
+} // namespace Http
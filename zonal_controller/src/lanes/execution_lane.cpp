@@ -0,0 +1,195 @@
+#include "../include/lanes/execution_lane.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "../include/rpc/async_unary_call.h"
+#include "../include/logger.hpp"
+
+namespace Lanes
+{
+    const char *LaneName(Lane lane)
+    {
+        return lane == Lane::CONTROL ? "control" : "telemetry";
+    }
+
+    std::chrono::steady_clock::time_point CallStarted(const grpc::ServerContextBase &context)
+    {
+        // Longest send-to-receive age accepted before the stamp is treated as clock skew
+        constexpr std::chrono::seconds kMaxSentAge(60);
+
+        auto now = std::chrono::steady_clock::now();
+        const auto &metadata = context.client_metadata();
+        auto it = metadata.find(kSentAtMetadataKey);
+        if (it == metadata.end()) return now;
+
+        int64_t sent_us = 0;
+        const char *first = it->second.data();
+        const char *last = first + it->second.size();
+        auto [end, error] = std::from_chars(first, last, sent_us);
+        if (error != std::errc() || end != last) return now;
+
+        auto age = std::chrono::system_clock::now().time_since_epoch() - std::chrono::microseconds(sent_us);
+        if (age < std::chrono::system_clock::duration::zero() || age > kMaxSentAge) return now;
+        return now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(age);
+    }
+
+    LatencyHistogram &Histogram(Lane lane)
+    {
+        static LatencyHistogram control;
+        static LatencyHistogram telemetry;
+        return lane == Lane::CONTROL ? control : telemetry;
+    }
+
+    void ApplyThreadPolicy(const zonal_controller::LaneConfig &config)
+    {
+        if (!config.cpus.empty())
+        {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            for (int cpu : config.cpus)
+            {
+                if (cpu >= 0 && cpu < CPU_SETSIZE)
+                {
+                    CPU_SET(cpu, &cpus);
+                }
+            }
+            int result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+            if (result != 0)
+            {
+                LOG_WARNING("Could not pin {} lane thread: {}", config.name, std::strerror(result));
+            }
+        }
+
+        if (config.schedFifoPriority > 0)
+        {
+            sched_param param{};
+            param.sched_priority = config.schedFifoPriority;
+            int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+            if (result != 0)
+            {
+                LOG_WARNING("Could not set SCHED_FIFO {} on {} lane thread: {}", config.schedFifoPriority,
+                            config.name, std::strerror(result));
+            }
+        }
+        else if (config.nice != 0)
+        {
+            // On Linux, PRIO_PROCESS with a thread id adjusts only that thread
+            auto tid = static_cast<id_t>(syscall(SYS_gettid));
+            if (setpriority(PRIO_PROCESS, tid, config.nice) != 0)
+            {
+                LOG_WARNING("Could not set nice {} on {} lane thread: {}", config.nice, config.name,
+                            std::strerror(errno));
+            }
+        }
+    }
+
+    void EnterLane(Lane lane)
+    {
+        auto &config = zonal_controller::Config::getInstance();
+        ApplyThreadPolicy(lane == Lane::CONTROL ? config.getControlLane() : config.getTelemetryLane());
+    }
+
+    CompletionQueueLane::CompletionQueueLane(const zonal_controller::LaneConfig &config,
+                                             std::unique_ptr<grpc::ServerCompletionQueue> queue)
+        : config_(config), queue_(std::move(queue))
+    {
+    }
+
+    CompletionQueueLane::~CompletionQueueLane()
+    {
+        stop();
+    }
+
+    void CompletionQueueLane::start()
+    {
+        int count = std::max(1, config_.threads);
+        for (int i = 0; i < count; ++i)
+        {
+            threads_.emplace_back(&CompletionQueueLane::Run, this);
+        }
+        LOG_INFO("Started {} lane with {} threads", config_.name, count);
+    }
+
+    void CompletionQueueLane::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(arm_mutex_);
+            if (stopping_) return;
+            stopping_ = true;
+            queue_->Shutdown();
+        }
+        for (auto &thread : threads_)
+        {
+            thread.join();
+        }
+        threads_.clear();
+    }
+
+    void CompletionQueueLane::Run()
+    {
+        ApplyThreadPolicy(config_);
+
+        void *tag = nullptr;
+        bool ok = false;
+        while (queue_->Next(&tag, &ok))
+        {
+            static_cast<Rpc::CompletionTag *>(tag)->Proceed(ok);
+        }
+    }
+
+    LatencyReporter::LatencyReporter(std::chrono::seconds interval) : interval_(interval)
+    {
+        if (interval_.count() > 0)
+        {
+            thread_ = std::thread(&LatencyReporter::Run, this);
+        }
+    }
+
+    LatencyReporter::~LatencyReporter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_all();
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+    }
+
+    void LatencyReporter::Run()
+    {
+        LatencyHistogram::Counts previous[2] = {Histogram(Lane::CONTROL).counts(),
+                                                 Histogram(Lane::TELEMETRY).counts()};
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!cv_.wait_for(lock, interval_, [this] { return !running_; }))
+        {
+            for (Lane lane : {Lane::CONTROL, Lane::TELEMETRY})
+            {
+                auto &last = previous[lane == Lane::CONTROL ? 0 : 1];
+                LatencyHistogram::Counts current = Histogram(lane).counts();
+                LatencyHistogram::Counts window{};
+                for (std::size_t i = 0; i < LatencyHistogram::kBuckets; ++i)
+                {
+                    window[i] = current[i] - last[i];
+                }
+                last = current;
+
+                uint64_t calls = LatencyHistogram::total(window);
+                if (calls == 0) continue;
+                LOG_INFO("{} lane: {} calls, p50 <= {} us, p99 <= {} us", LaneName(lane), calls,
+                         static_cast<long>(LatencyHistogram::percentile(window, 50.0).count()),
+                         static_cast<long>(LatencyHistogram::percentile(window, 99.0).count()));
+            }
+        }
+    }
+
+} // namespace Lanes
@@ -0,0 +1,105 @@
+#include "../include/obd2/iso_tp.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace Obd2
+{
+    namespace
+    {
+        void Pad(std::size_t used, const IsoTpOptions &options, can_frame &frame)
+        {
+            if (options.padding) {
+                std::memset(frame.data + used, options.padding_byte, CAN_MAX_DLEN - used);
+                frame.can_dlc = CAN_MAX_DLEN;
+            } else {
+                frame.can_dlc = static_cast<uint8_t>(used);
+            }
+        }
+    }
+
+    void MakeSingleFrame(uint32_t id, const uint8_t *data, std::size_t size, const IsoTpOptions &options,
+                         can_frame &frame)
+    {
+        frame.can_id = id;
+        frame.data[0] = static_cast<uint8_t>(size);
+        std::memcpy(frame.data + 1, data, size);
+        Pad(1 + size, options, frame);
+    }
+
+    void MakeFirstFrame(uint32_t id, const uint8_t *data, std::size_t size, can_frame &frame)
+    {
+        // Always a full frame, so padding never applies
+        frame.can_id = id;
+        frame.can_dlc = CAN_MAX_DLEN;
+        frame.data[0] = static_cast<uint8_t>(0x10 | ((size >> 8) & 0x0F));
+        frame.data[1] = static_cast<uint8_t>(size);
+        std::memcpy(frame.data + 2, data, kFirstFrameData);
+    }
+
+    void MakeConsecutiveFrame(uint32_t id, uint8_t sequence, const uint8_t *data, std::size_t size,
+                              const IsoTpOptions &options, can_frame &frame)
+    {
+        frame.can_id = id;
+        frame.data[0] = static_cast<uint8_t>(0x20 | (sequence & 0x0F));
+        std::memcpy(frame.data + 1, data, size);
+        Pad(1 + size, options, frame);
+    }
+
+    void MakeFlowControl(uint32_t id, FlowStatus status, uint8_t block_size, uint8_t st_min,
+                         const IsoTpOptions &options, can_frame &frame)
+    {
+        frame.can_id = id;
+        frame.data[0] = static_cast<uint8_t>(0x30 | static_cast<uint8_t>(status));
+        frame.data[1] = block_size;
+        frame.data[2] = st_min;
+        Pad(3, options, frame);
+    }
+
+    std::chrono::microseconds DecodeSeparationTime(uint8_t st_min)
+    {
+        if (st_min <= 0x7F) return std::chrono::milliseconds(st_min);
+        if (st_min >= 0xF1 && st_min <= 0xF9) return std::chrono::microseconds((st_min - 0xF0) * 100);
+        return std::chrono::milliseconds(0x7F);
+    }
+
+    uint8_t EncodeSeparationTime(std::chrono::microseconds separation)
+    {
+        auto us = separation.count();
+        if (us <= 0) return 0;
+        if (us <= 900) return static_cast<uint8_t>(0xF0 + (us + 99) / 100);
+        return static_cast<uint8_t>(std::min<long long>(0x7F, (us + 999) / 1000));
+    }
+
+    int OpenCanSocket(const std::string &interface, const std::vector<uint32_t> &receive_ids)
+    {
+        int fd = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open CAN socket: " + std::string(std::strerror(errno)));
+        }
+
+        // Only standard data frames with the given identifiers
+        std::vector<can_filter> filters;
+        for (uint32_t id : receive_ids) {
+            filters.push_back({id, CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG});
+        }
+        sockaddr_can addr{};
+        addr.can_family = AF_CAN;
+        addr.can_ifindex = static_cast<int>(if_nametoindex(interface.c_str()));
+        if (addr.can_ifindex == 0 ||
+            setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, filters.data(),
+                       static_cast<socklen_t>(filters.size() * sizeof(can_filter))) != 0 ||
+            bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+            std::string error = std::strerror(errno);
+            close(fd);
+            throw std::runtime_error("Failed to open CAN interface " + interface + ": " + error);
+        }
+        return fd;
+    }
+
+} // namespace Obd2
@@ -0,0 +1,108 @@
+#include "../include/obd2/iso_tp_client.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace Obd2
+{
+    namespace
+    {
+        bool Fail(std::string *error, std::string reason)
+        {
+            if (error != nullptr) *error = std::move(reason);
+            return false;
+        }
+    }
+
+    bool IsoTpClient::request(const uint8_t *request, std::size_t size, std::vector<uint8_t> &response,
+                              std::chrono::milliseconds timeout, std::string *error)
+    {
+        response.clear();
+        if (size == 0 || size > kSingleFrameMax) return Fail(error, "request does not fit in a single frame");
+
+        // Drop anything left over from an earlier, abandoned response
+        can_frame frame;
+        while (recv(socket_, &frame, sizeof(frame), MSG_DONTWAIT) > 0) {
+        }
+
+        MakeSingleFrame(options_.request_id, request, size, options_.iso_tp, frame);
+        if (!Send(frame, error)) return false;
+
+        if (!Receive(frame, std::chrono::steady_clock::now() + timeout, error)) return false;
+        switch (TypeOf(frame)) {
+        case FrameType::SINGLE: {
+            std::size_t length = frame.data[0] & 0x0F;
+            if (length == 0 || length > static_cast<std::size_t>(frame.can_dlc) - 1) {
+                return Fail(error, "malformed single frame");
+            }
+            response.assign(frame.data + 1, frame.data + 1 + length);
+            return true;
+        }
+        case FrameType::FIRST:
+            break;
+        default:
+            return Fail(error, "unexpected frame type");
+        }
+
+        std::size_t length = (static_cast<std::size_t>(frame.data[0] & 0x0F) << 8) | frame.data[1];
+        if (length <= kSingleFrameMax || frame.can_dlc != CAN_MAX_DLEN) return Fail(error, "malformed first frame");
+        response.reserve(length);
+        response.assign(frame.data + 2, frame.data + 2 + kFirstFrameData);
+
+        uint8_t sequence = 1;
+        while (response.size() < length) {
+            can_frame flow_control;
+            MakeFlowControl(options_.flow_control_id, FlowStatus::CONTINUE, options_.block_size, options_.st_min,
+                            options_.iso_tp, flow_control);
+            if (!Send(flow_control, error)) return false;
+
+            for (unsigned received = 0; response.size() < length &&
+                                        (options_.block_size == 0 || received < options_.block_size);
+                 ++received) {
+                if (!Receive(frame, std::chrono::steady_clock::now() + timeout, error)) return false;
+                if (TypeOf(frame) != FrameType::CONSECUTIVE) return Fail(error, "expected a consecutive frame");
+                if ((frame.data[0] & 0x0F) != sequence) return Fail(error, "consecutive frame out of sequence");
+                sequence = static_cast<uint8_t>((sequence + 1) & 0x0F);
+
+                std::size_t chunk = std::min(kConsecutiveFrameData, length - response.size());
+                if (frame.can_dlc < 1 + chunk) return Fail(error, "short consecutive frame");
+                response.insert(response.end(), frame.data + 1, frame.data + 1 + chunk);
+            }
+        }
+        return true;
+    }
+
+    bool IsoTpClient::Receive(can_frame &frame, std::chrono::steady_clock::time_point deadline, std::string *error)
+    {
+        while (true) {
+            ssize_t bytes = recv(socket_, &frame, sizeof(frame), MSG_DONTWAIT);
+            if (bytes == static_cast<ssize_t>(sizeof(frame))) {
+                if ((frame.can_id & CAN_SFF_MASK) == options_.response_id && frame.can_dlc > 0 &&
+                    !(frame.can_id & (CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_ERR_FLAG))) {
+                    return true;
+                }
+                continue;
+            }
+            if (bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                return Fail(error, std::string("read failed: ") + std::strerror(errno));
+            }
+            if (bytes == 0) return Fail(error, "socket closed");
+
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+            if (remaining.count() < 0) return Fail(error, "timed out");
+            pollfd fd{socket_, POLLIN, 0};
+            poll(&fd, 1, static_cast<int>(remaining.count()) + 1);
+        }
+    }
+
+    bool IsoTpClient::Send(const can_frame &frame, std::string *error)
+    {
+        if (write(socket_, &frame, sizeof(frame)) == static_cast<ssize_t>(sizeof(frame))) return true;
+        return Fail(error, std::string("write failed: ") + std::strerror(errno));
+    }
+
+} // namespace Obd2
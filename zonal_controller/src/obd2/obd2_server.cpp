@@ -0,0 +1,308 @@
+#include "../include/obd2/obd2_server.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "../include/lanes/execution_lane.h"
+#include "../include/logger.hpp"
+#include "../include/tracing/span.h"
+
+namespace Obd2
+{
+    namespace
+    {
+        // N_Bs: how long to wait for the tester's flow control frame
+        constexpr std::chrono::milliseconds kFlowControlTimeout(1000);
+        // Flow control WAIT frames accepted in a row before giving up (N_WFTmax)
+        constexpr int kMaxWaitFrames = 10;
+        // Retry delay when the interface transmit queue is full
+        constexpr std::chrono::milliseconds kQueueFullRetry(1);
+        // N_As: how long a full transmit queue may hold up the first frame of a response
+        constexpr std::chrono::milliseconds kTransmitTimeout(1000);
+
+        std::string ToHex(uint32_t id)
+        {
+            char buf[16];
+            std::snprintf(buf, sizeof(buf), "%03X", id);
+            return buf;
+        }
+    }
+
+    Obd2Server::Obd2Server(const Obd2ServerOptions &options, const VehicleStateSource &source)
+        : options_(options), source_(source)
+    {
+        socket_ = OpenCanSocket(options_.interface, {options_.request_id, options_.functional_id});
+        Start();
+        LOG_INFO("OBD-II server on {} (request 0x{}, functional 0x{}, response 0x{})", options_.interface,
+                 ToHex(options_.request_id), ToHex(options_.functional_id), ToHex(options_.response_id));
+    }
+
+    Obd2Server::Obd2Server(const Obd2ServerOptions &options, const VehicleStateSource &source, int socket)
+        : options_(options), source_(source), socket_(socket)
+    {
+        Start();
+    }
+
+    Obd2Server::~Obd2Server()
+    {
+        uint64_t one = 1;
+        if (write(wake_fd_, &one, sizeof(one)) < 0) {
+            LOG_WARNING("Failed to wake OBD-II loop: {}", std::strerror(errno));
+        }
+        if (loop_thread_.joinable()) loop_thread_.join();
+        for (int fd : {socket_, wake_fd_}) {
+            if (fd >= 0) close(fd);
+        }
+
+        Obd2ServerStats totals = stats();
+        LOG_INFO("OBD-II server stopped: {} requests, {} responses ({} negative, {} segmented), {} aborted",
+                 totals.requests, totals.responses, totals.negative, totals.segmented, totals.aborted);
+    }
+
+    Obd2ServerStats Obd2Server::stats() const
+    {
+        Obd2ServerStats stats;
+        stats.requests = requests_.load(std::memory_order_relaxed);
+        stats.responses = responses_.load(std::memory_order_relaxed);
+        stats.negative = negative_.load(std::memory_order_relaxed);
+        stats.segmented = segmented_.load(std::memory_order_relaxed);
+        stats.aborted = aborted_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void Obd2Server::Start()
+    {
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wake_fd_ < 0) {
+            std::string error = std::strerror(errno);
+            close(socket_);
+            throw std::runtime_error("Failed to create OBD-II wake event: " + error);
+        }
+        loop_thread_ = std::thread(&Obd2Server::Loop, this);
+    }
+
+    void Obd2Server::Loop()
+    {
+        Lanes::EnterLane(Lanes::Lane::TELEMETRY);
+        pollfd fds[2] = {{socket_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+
+        while (true) {
+            // Sleep until a frame arrives or the segmented response has something due
+            timespec timeout{};
+            timespec *timeout_ptr = nullptr;
+            if (tx_.active) {
+                auto due = tx_.waiting_flow_control ? tx_.deadline : tx_.next_frame;
+                auto wait = std::max(Clock::duration::zero(), due - Clock::now());
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count();
+                timeout.tv_sec = static_cast<time_t>(ns / 1000000000);
+                timeout.tv_nsec = static_cast<long>(ns % 1000000000);
+                timeout_ptr = &timeout;
+            }
+
+            int count = ppoll(fds, 2, timeout_ptr, nullptr);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                LOG_ERROR("OBD-II poll failed: {}", std::strerror(errno));
+                return;
+            }
+            if (fds[1].revents != 0) return;
+
+            if (fds[0].revents & POLLIN) {
+                can_frame frame;
+                ssize_t bytes;
+                while ((bytes = recv(socket_, &frame, sizeof(frame), 0)) > 0) {
+                    if (static_cast<std::size_t>(bytes) == sizeof(frame)) OnFrame(frame);
+                }
+                if (bytes == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                    LOG_ERROR("OBD-II socket read failed: {}", bytes == 0 ? "closed" : std::strerror(errno));
+                    return;
+                }
+            } else if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                LOG_ERROR("OBD-II socket error on {}", options_.interface);
+                return;
+            }
+
+            Transmit(Clock::now());
+        }
+    }
+
+    void Obd2Server::OnFrame(const can_frame &frame)
+    {
+        if (frame.can_id & (CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_ERR_FLAG) || frame.can_dlc == 0) return;
+        uint32_t id = frame.can_id & CAN_SFF_MASK;
+        bool functional = id == options_.functional_id;
+        if (!functional && id != options_.request_id) return;
+
+        switch (TypeOf(frame)) {
+        case FrameType::SINGLE: {
+            std::size_t size = frame.data[0] & 0x0F;
+            if (size == 0 || size > static_cast<std::size_t>(frame.can_dlc) - 1) return;
+            // A tester that sends a new request has given up on the previous response
+            if (tx_.active) Abort("new request");
+            HandleRequest(frame.data + 1, size, functional);
+            break;
+        }
+        case FrameType::FIRST:
+            // No OBD-II request needs segmenting, so refuse rather than reassemble
+            if (!functional) {
+                can_frame reply;
+                MakeFlowControl(options_.response_id, FlowStatus::OVERFLOW, 0, 0, options_.iso_tp, reply);
+                Write(reply);
+            }
+            break;
+        case FrameType::FLOW_CONTROL:
+            if (!functional && tx_.active && tx_.waiting_flow_control) OnFlowControl(frame);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void Obd2Server::HandleRequest(const uint8_t *request, std::size_t size, bool functional)
+    {
+        TRACE_SPAN("Obd2.request");
+        requests_.fetch_add(1, std::memory_order_relaxed);
+
+        std::size_t response_size = 0;
+        ResponseKind kind = BuildResponse(request, size, source_.snapshot(), functional, tx_.data.data(),
+                                          response_size);
+        if (kind == ResponseKind::NONE) return;
+        if (kind == ResponseKind::NEGATIVE) negative_.fetch_add(1, std::memory_order_relaxed);
+
+        // Sent through Transmit(), so a full transmit queue is retried like a consecutive frame
+        auto now = Clock::now();
+        tx_.active = true;
+        tx_.started = false;
+        tx_.waiting_flow_control = false;
+        tx_.size = response_size;
+        tx_.offset = 0;
+        tx_.next_frame = now;
+        tx_.deadline = now + kTransmitTimeout;
+        Transmit(now);
+    }
+
+    void Obd2Server::SendFirstFrame(Clock::time_point now)
+    {
+        can_frame frame;
+        bool single = tx_.size <= kSingleFrameMax;
+        if (single) {
+            MakeSingleFrame(options_.response_id, tx_.data.data(), tx_.size, options_.iso_tp, frame);
+        } else {
+            MakeFirstFrame(options_.response_id, tx_.data.data(), tx_.size, frame);
+        }
+        if (!Write(frame)) {
+            if ((errno == ENOBUFS || errno == EAGAIN) && now < tx_.deadline) {
+                tx_.next_frame = now + kQueueFullRetry;
+            } else {
+                Abort("write failed");
+            }
+            return;
+        }
+
+        tx_.started = true;
+        if (single) {
+            tx_.active = false;
+            responses_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        segmented_.fetch_add(1, std::memory_order_relaxed);
+        tx_.waiting_flow_control = true;
+        tx_.offset = kFirstFrameData;
+        tx_.sequence = 1;
+        tx_.waits = 0;
+        tx_.deadline = now + kFlowControlTimeout;
+    }
+
+    void Obd2Server::OnFlowControl(const can_frame &frame)
+    {
+        if (frame.can_dlc < 3) return;
+        switch (static_cast<FlowStatus>(frame.data[0] & 0x0F)) {
+        case FlowStatus::CONTINUE:
+            tx_.waiting_flow_control = false;
+            tx_.block_size = frame.data[1];
+            tx_.block_remaining = frame.data[1];
+            tx_.separation = DecodeSeparationTime(frame.data[2]);
+            tx_.next_frame = Clock::now();
+            break;
+        case FlowStatus::WAIT:
+            if (++tx_.waits > kMaxWaitFrames) {
+                Abort("too many flow control waits");
+            } else {
+                tx_.deadline = Clock::now() + kFlowControlTimeout;
+            }
+            break;
+        case FlowStatus::OVERFLOW:
+            Abort("tester reported overflow");
+            break;
+        default:
+            Abort("invalid flow status");
+            break;
+        }
+    }
+
+    void Obd2Server::Transmit(Clock::time_point now)
+    {
+        if (tx_.active && !tx_.started) {
+            if (now >= tx_.next_frame) SendFirstFrame(now);
+            return;
+        }
+        if (tx_.active && tx_.waiting_flow_control) {
+            if (now >= tx_.deadline) Abort("flow control timeout");
+            return;
+        }
+
+        while (tx_.active && now >= tx_.next_frame) {
+            std::size_t chunk = std::min(kConsecutiveFrameData, tx_.size - tx_.offset);
+            can_frame frame;
+            MakeConsecutiveFrame(options_.response_id, tx_.sequence, tx_.data.data() + tx_.offset, chunk,
+                                 options_.iso_tp, frame);
+            if (!Write(frame)) {
+                if (errno == ENOBUFS || errno == EAGAIN) {
+                    tx_.next_frame = now + kQueueFullRetry;
+                } else {
+                    Abort("write failed");
+                }
+                return;
+            }
+
+            tx_.offset += chunk;
+            tx_.sequence = static_cast<uint8_t>((tx_.sequence + 1) & 0x0F);
+            if (tx_.offset == tx_.size) {
+                tx_.active = false;
+                responses_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            if (tx_.block_size != 0 && --tx_.block_remaining == 0) {
+                tx_.waiting_flow_control = true;
+                tx_.waits = 0;
+                tx_.deadline = now + kFlowControlTimeout;
+                return;
+            }
+            tx_.next_frame = now + tx_.separation;
+        }
+    }
+
+    void Obd2Server::Abort(const char *reason)
+    {
+        LOG_DEBUG("OBD-II response aborted after {} of {} bytes: {}", tx_.offset, tx_.size, reason);
+        tx_.active = false;
+        aborted_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool Obd2Server::Write(const can_frame &frame)
+    {
+        if (write(socket_, &frame, sizeof(frame)) == static_cast<ssize_t>(sizeof(frame))) return true;
+        int error = errno;
+        if (error != ENOBUFS && error != EAGAIN) {
+            LOG_WARNING("OBD-II frame write failed: {}", std::strerror(error));
+        }
+        errno = error;  // Callers retry on a full queue
+        return false;
+    }
+
+} // namespace Obd2
@@ -0,0 +1,89 @@
+#include "../include/obd2/pid_query.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "../include/obd2/pid_table.h"
+
+namespace Obd2
+{
+    namespace
+    {
+        void FillValue(uint8_t mode, uint8_t pid, const VehicleState &state, obd::PidValue *value)
+        {
+            value->set_pid(pid);
+            uint8_t data[32];
+            std::size_t length = EncodePid(mode, pid, state, data);
+            value->set_supported(length > 0);
+            if (length == 0) return;
+            value->set_data(data, length);
+
+            const PidHandler *handler = FindPid(mode, pid);
+            if (handler == nullptr) {
+                // Supported-PID bitmap
+                char name[32];
+                std::snprintf(name, sizeof(name), "pids_supported_%02X_%02X", pid + 1, pid + 0x20);
+                value->set_name(name);
+                value->set_value(static_cast<double>((uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) |
+                                                     (uint32_t(data[2]) << 8) | data[3]));
+                return;
+            }
+
+            value->set_name(handler->name);
+            value->set_unit(handler->unit);
+            if (handler->decode != nullptr) {
+                value->set_value(handler->decode(data));
+            }
+            if (handler->text) {
+                const char *text = reinterpret_cast<const char *>(data + 1);
+                value->set_text(text, strnlen(text, length - 1));
+            }
+        }
+    }
+
+    grpc::Status FillQueryPidsResponse(const VehicleState &state, const obd::QueryPidsRequest &request,
+                                       obd::QueryPidsResponse *response)
+    {
+        if (request.queries_size() > kMaxQueriesPerBatch) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                "At most " + std::to_string(kMaxQueriesPerBatch) + " queries per call");
+        }
+        for (const auto &query : request.queries()) {
+            if (query.mode() > 0xFF ||
+                std::any_of(query.pids().begin(), query.pids().end(), [](uint32_t pid) { return pid > 0xFF; })) {
+                return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Modes and PIDs are single bytes");
+            }
+        }
+
+        response->mutable_results()->Reserve(request.queries_size());
+        for (const auto &query : request.queries()) {
+            obd::PidQueryResult *result = response->add_results();
+            uint8_t mode = static_cast<uint8_t>(query.mode());
+            result->set_mode(mode);
+
+            // Requests longer than a single frame are refused on the bus too, so clamp before copying
+            uint8_t message[1 + kMaxPidsPerRequest + 1];
+            std::size_t size = 0;
+            message[size++] = mode;
+            for (int i = 0; i < query.pids_size() && size < sizeof(message); ++i) {
+                message[size++] = static_cast<uint8_t>(query.pids(i));
+            }
+
+            uint8_t payload[kMaxResponseSize];
+            std::size_t payload_size = 0;
+            ResponseKind kind = BuildResponse(message, size, state, false, payload, payload_size);
+            result->set_payload(payload, payload_size);
+            if (kind == ResponseKind::NEGATIVE) {
+                result->set_negative_response_code(payload[2]);
+                continue;
+            }
+
+            result->mutable_values()->Reserve(query.pids_size());
+            for (uint32_t pid : query.pids()) {
+                FillValue(mode, static_cast<uint8_t>(pid), state, result->add_values());
+            }
+        }
+        return grpc::Status::OK;
+    }
+
+} // namespace Obd2
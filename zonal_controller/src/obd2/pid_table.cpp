@@ -0,0 +1,211 @@
+#include "../include/obd2/pid_table.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Obd2
+{
+    namespace
+    {
+        constexpr uint8_t kVinLength = 17;
+        constexpr uint8_t kEcuNameLength = 20;
+
+        // 01 01: MIL off, no stored trouble codes, no readiness tests reported
+        void EncodeMonitorStatus(const VehicleState &, uint8_t *out)
+        {
+            std::memset(out, 0, 4);
+        }
+
+        double DecodeMonitorStatus(const uint8_t *data)
+        {
+            return data[0] & 0x7F;
+        }
+
+        // 01 1F: seconds since the controller started, saturating at 65535
+        void EncodeRunTime(const VehicleState &state, uint8_t *out)
+        {
+            uint32_t seconds = std::min<uint32_t>(state.run_time_s, 0xFFFF);
+            out[0] = static_cast<uint8_t>(seconds >> 8);
+            out[1] = static_cast<uint8_t>(seconds);
+        }
+
+        double DecodeRunTime(const uint8_t *data)
+        {
+            return data[0] * 256.0 + data[1];
+        }
+
+        // 01 2F: 100/255 * A
+        void EncodeFuelLevel(const VehicleState &state, uint8_t *out)
+        {
+            float level = std::clamp(state.fuel_level_percent, 0.0f, 100.0f);
+            out[0] = static_cast<uint8_t>(std::lround(level * 255.0f / 100.0f));
+        }
+
+        double DecodeFuelLevel(const uint8_t *data)
+        {
+            return data[0] * 100.0 / 255.0;
+        }
+
+        // Mode 09 text items: number of data items (always 1), then the text padded with zeros
+        void EncodeText(std::string_view text, uint8_t length, uint8_t *out)
+        {
+            out[0] = 1;
+            std::size_t used = std::min<std::size_t>(text.size(), length);
+            std::memcpy(out + 1, text.data(), used);
+            std::memset(out + 1 + used, 0, length - used);
+        }
+
+        void EncodeVin(const VehicleState &state, uint8_t *out)
+        {
+            EncodeText(state.vin, kVinLength, out);
+        }
+
+        void EncodeEcuName(const VehicleState &state, uint8_t *out)
+        {
+            EncodeText(state.ecu_name, kEcuNameLength, out);
+        }
+
+        // Sorted by PID
+        constexpr PidHandler kCurrentData[] = {
+            {0x01, 4, "monitor_status", "", EncodeMonitorStatus, DecodeMonitorStatus, false},
+            {0x1F, 2, "run_time", "s", EncodeRunTime, DecodeRunTime, false},
+            {0x2F, 1, "fuel_tank_level", "%", EncodeFuelLevel, DecodeFuelLevel, false},
+        };
+
+        constexpr PidHandler kVehicleInfo[] = {
+            {0x02, 1 + kVinLength, "vin", "", EncodeVin, nullptr, true},
+            {0x0A, 1 + kEcuNameLength, "ecu_name", "", EncodeEcuName, nullptr, true},
+        };
+
+        template <std::size_t N>
+        const PidHandler *Find(const PidHandler (&table)[N], uint8_t pid)
+        {
+            auto it = std::lower_bound(std::begin(table), std::end(table), pid,
+                                       [](const PidHandler &handler, uint8_t value) { return handler.pid < value; });
+            return it != std::end(table) && it->pid == pid ? it : nullptr;
+        }
+
+        const PidHandler *Table(uint8_t mode, std::size_t &size)
+        {
+            switch (mode) {
+            case kModeCurrentData:
+                size = std::size(kCurrentData);
+                return kCurrentData;
+            case kModeVehicleInfo:
+                size = std::size(kVehicleInfo);
+                return kVehicleInfo;
+            default:
+                size = 0;
+                return nullptr;
+            }
+        }
+
+        bool IsBitmapPid(uint8_t pid)
+        {
+            return (pid & 0x1F) == 0;
+        }
+
+        // Bit 31 is base + 1, bit 0 is base + 0x20 (the next bitmap)
+        uint32_t SupportedBitmap(uint8_t mode, uint8_t base)
+        {
+            uint32_t bitmap = 0;
+            for (unsigned offset = 1; offset <= 0x20 && base + offset <= 0xFF; ++offset) {
+                if (Supported(mode, static_cast<uint8_t>(base + offset))) {
+                    bitmap |= 1u << (32 - offset);
+                }
+            }
+            return bitmap;
+        }
+
+        ResponseKind Negative(uint8_t mode, uint8_t code, bool functional, uint8_t *out, std::size_t &out_size)
+        {
+            // ECUs stay silent on functional requests they cannot serve (ISO 15765-4)
+            if (functional) return ResponseKind::NONE;
+            out[0] = kNegativeResponse;
+            out[1] = mode;
+            out[2] = code;
+            out_size = 3;
+            return ResponseKind::NEGATIVE;
+        }
+    }
+
+    const PidHandler *FindPid(uint8_t mode, uint8_t pid)
+    {
+        switch (mode) {
+        case kModeCurrentData:
+            return Find(kCurrentData, pid);
+        case kModeVehicleInfo:
+            return Find(kVehicleInfo, pid);
+        default:
+            return nullptr;
+        }
+    }
+
+    bool Supported(uint8_t mode, uint8_t pid)
+    {
+        std::size_t size;
+        const PidHandler *table = Table(mode, size);
+        if (table == nullptr) return false;
+        if (!IsBitmapPid(pid)) return FindPid(mode, pid) != nullptr;
+        // A bitmap is supported when it is the first one or a later PID exists
+        return pid == 0 || (size > 0 && table[size - 1].pid > pid);
+    }
+
+    std::size_t EncodePid(uint8_t mode, uint8_t pid, const VehicleState &state, uint8_t *out)
+    {
+        if (IsBitmapPid(pid)) {
+            if (!Supported(mode, pid)) return 0;
+            uint32_t bitmap = SupportedBitmap(mode, pid);
+            out[0] = static_cast<uint8_t>(bitmap >> 24);
+            out[1] = static_cast<uint8_t>(bitmap >> 16);
+            out[2] = static_cast<uint8_t>(bitmap >> 8);
+            out[3] = static_cast<uint8_t>(bitmap);
+            return 4;
+        }
+
+        const PidHandler *handler = FindPid(mode, pid);
+        if (handler == nullptr) return 0;
+        handler->encode(state, out);
+        return handler->length;
+    }
+
+    ResponseKind BuildResponse(const uint8_t *request, std::size_t request_size, const VehicleState &state,
+                               bool functional, uint8_t *out, std::size_t &out_size)
+    {
+        out_size = 0;
+        if (request_size == 0) return ResponseKind::NONE;
+
+        uint8_t mode = request[0];
+        if (mode != kModeCurrentData && mode != kModeVehicleInfo) {
+            return Negative(mode, kServiceNotSupported, functional, out, out_size);
+        }
+
+        const uint8_t *pids = request + 1;
+        std::size_t count = request_size - 1;
+        if (count == 0 || count > kMaxPidsPerRequest) {
+            return Negative(mode, kIncorrectMessageLength, functional, out, out_size);
+        }
+        if (mode == kModeVehicleInfo && count > 1 &&
+            !std::all_of(pids, pids + count, [](uint8_t pid) { return IsBitmapPid(pid); })) {
+            return Negative(mode, kIncorrectMessageLength, functional, out, out_size);
+        }
+
+        std::size_t size = 0;
+        out[size++] = static_cast<uint8_t>(mode + kPositiveResponseOffset);
+        for (std::size_t i = 0; i < count; ++i) {
+            uint8_t data[32];
+            std::size_t length = EncodePid(mode, pids[i], state, data);
+            if (length == 0) continue;
+            out[size++] = pids[i];
+            std::memcpy(out + size, data, length);
+            size += length;
+        }
+
+        if (size == 1) {
+            return Negative(mode, kSubFunctionNotSupported, functional, out, out_size);
+        }
+        out_size = size;
+        return ResponseKind::POSITIVE;
+    }
+
+} // namespace Obd2
@@ -0,0 +1,420 @@
+#include "../include/rules/rule_compiler.h"
+#include <cctype>
+#include <cstdlib>
+#include <vector>
+
+namespace Rules
+{
+    const char *SignalName(Signal signal)
+    {
+        switch (signal)
+        {
+        case Signal::FUEL_LEVEL:
+            return "fuel_level";
+        case Signal::HEADLIGHTS:
+            return "headlights";
+        default:
+            return "unknown";
+        }
+    }
+
+    bool Program::evaluate(const SignalValues &signals, double hysteresis) const
+    {
+        double stack[kMaxStack];
+        std::size_t top = 0;
+
+        for (const Instruction &instruction : code_)
+        {
+            switch (instruction.op)
+            {
+            case OpCode::PUSH_CONST:
+                stack[top++] = constants_[instruction.arg];
+                continue;
+            case OpCode::LOAD_SIGNAL:
+                stack[top++] = signals[instruction.arg];
+                continue;
+            case OpCode::NOT:
+                stack[top - 1] = stack[top - 1] != 0.0 ? 0.0 : 1.0;
+                continue;
+            default:
+                break;
+            }
+
+            double right = stack[--top];
+            double left = stack[top - 1];
+            bool result = false;
+            switch (instruction.op)
+            {
+            // Widen thresholds while raised so the rule does not chatter around them
+            case OpCode::LT:
+                result = left < right + hysteresis;
+                break;
+            case OpCode::LE:
+                result = left <= right + hysteresis;
+                break;
+            case OpCode::GT:
+                result = left > right - hysteresis;
+                break;
+            case OpCode::GE:
+                result = left >= right - hysteresis;
+                break;
+            case OpCode::EQ:
+                result = left == right;
+                break;
+            case OpCode::NE:
+                result = left != right;
+                break;
+            case OpCode::AND:
+                result = left != 0.0 && right != 0.0;
+                break;
+            case OpCode::OR:
+                result = left != 0.0 || right != 0.0;
+                break;
+            default:
+                break;
+            }
+            stack[top - 1] = result ? 1.0 : 0.0;
+        }
+        return top == 1 && stack[0] != 0.0;
+    }
+
+    /**
+     * @brief Recursive-descent parser emitting bytecode as it goes
+     */
+    class Compiler
+    {
+    public:
+        Compiler(const std::string &text, Program *program) : text_(text), program_(program) {}
+
+        bool Run(std::string *error)
+        {
+            program_->code_.clear();
+            program_->constants_.clear();
+            program_->signal_mask_ = 0;
+
+            bool ok = ParseOr() && Expect("");
+            if (ok && max_depth_ > Program::kMaxStack)
+            {
+                error_ = "condition is too deeply nested";
+                ok = false;
+            }
+            if (ok)
+            {
+                PushDownNegation();
+            }
+            if (!ok && error)
+            {
+                *error = error_ + " at position " + std::to_string(pos_);
+            }
+            return ok;
+        }
+
+    private:
+        bool ParseOr()
+        {
+            if (!ParseAnd()) return false;
+            while (Accept("||") || AcceptWord("or"))
+            {
+                if (!ParseAnd()) return false;
+                Emit(OpCode::OR, 0, -1);
+            }
+            return true;
+        }
+
+        bool ParseAnd()
+        {
+            if (!ParseNot()) return false;
+            while (Accept("&&") || AcceptWord("and"))
+            {
+                if (!ParseNot()) return false;
+                Emit(OpCode::AND, 0, -1);
+            }
+            return true;
+        }
+
+        bool ParseNot()
+        {
+            if ((Peek() == '!' && Peek(1) != '=' && Accept("!")) || AcceptWord("not"))
+            {
+                if (!Nest()) return false;
+                bool ok = ParseNot();
+                --nesting_;
+                if (!ok) return false;
+                Emit(OpCode::NOT, 0, 0);
+                return true;
+            }
+            return ParseComparison();
+        }
+
+        bool ParseComparison()
+        {
+            if (!ParsePrimary()) return false;
+
+            static const struct
+            {
+                const char *token;
+                OpCode op;
+            } kOperators[] = {{"<=", OpCode::LE}, {">=", OpCode::GE}, {"==", OpCode::EQ}, {"!=", OpCode::NE},
+                              {"<", OpCode::LT},  {">", OpCode::GT}};
+
+            for (const auto &candidate : kOperators)
+            {
+                if (Accept(candidate.token))
+                {
+                    if (!ParsePrimary()) return false;
+                    Emit(candidate.op, 0, -1);
+                    return true;
+                }
+            }
+            return true;
+        }
+
+        bool ParsePrimary()
+        {
+            SkipSpace();
+            if (Accept("("))
+            {
+                if (!Nest()) return false;
+                bool ok = ParseOr() && Expect(")");
+                --nesting_;
+                return ok;
+            }
+
+            char c = Peek();
+            if (std::isdigit(static_cast<unsigned char>(c)) || c == '-' || c == '.')
+            {
+                const char *start = text_.c_str() + pos_;
+                char *end = nullptr;
+                double value = std::strtod(start, &end);
+                if (end == start)
+                {
+                    error_ = "expected a number";
+                    return false;
+                }
+                pos_ += static_cast<std::size_t>(end - start);
+                return PushConstant(value);
+            }
+
+            std::string word = ReadWord();
+            if (word.empty())
+            {
+                error_ = "expected a value";
+                return false;
+            }
+            if (word == "true" || word == "false")
+            {
+                return PushConstant(word == "true" ? 1.0 : 0.0);
+            }
+            for (std::size_t i = 0; i < kSignalCount; ++i)
+            {
+                if (word == SignalName(static_cast<Signal>(i)))
+                {
+                    Emit(OpCode::LOAD_SIGNAL, static_cast<uint16_t>(i), 1);
+                    program_->signal_mask_ |= 1u << i;
+                    return true;
+                }
+            }
+            pos_ -= word.size();
+            error_ = "unknown signal '" + word + "'";
+            return false;
+        }
+
+        // Rewrites the program so NOT only applies to plain values: not (a > b)
+        // becomes a <= b and not (a && b) becomes !a || !b. Every ordered
+        // comparison then tests the direction the rule actually means, so the
+        // hysteresis margin widens the raised condition instead of narrowing
+        // it. Operands and stack depth are unchanged. Iterative, since an
+        // and/or chain parses into a tree as deep as the chain is long.
+        void PushDownNegation()
+        {
+            struct Node
+            {
+                Instruction instruction;
+                std::size_t left;
+                std::size_t right;
+            };
+            std::vector<Node> nodes;
+            std::vector<std::size_t> operands;
+            nodes.reserve(program_->code_.size());
+            for (const Instruction &instruction : program_->code_)
+            {
+                Node node{instruction, 0, 0};
+                if (instruction.op == OpCode::NOT)
+                {
+                    node.left = operands.back();
+                    operands.pop_back();
+                }
+                else if (instruction.op != OpCode::PUSH_CONST && instruction.op != OpCode::LOAD_SIGNAL)
+                {
+                    node.right = operands.back();
+                    operands.pop_back();
+                    node.left = operands.back();
+                    operands.pop_back();
+                }
+                nodes.push_back(node);
+                operands.push_back(nodes.size() - 1);
+            }
+
+            struct Task
+            {
+                std::size_t node;
+                bool negate;
+                bool expanded;
+            };
+            std::vector<Instruction> code;
+            code.reserve(program_->code_.size());
+            std::vector<Task> tasks{{operands.back(), false, false}};
+            while (!tasks.empty())
+            {
+                Task task = tasks.back();
+                tasks.pop_back();
+                const Node &node = nodes[task.node];
+                OpCode op = node.instruction.op;
+
+                if (op == OpCode::NOT)
+                {
+                    tasks.push_back({node.left, !task.negate, false});
+                }
+                else if (op == OpCode::PUSH_CONST || op == OpCode::LOAD_SIGNAL)
+                {
+                    code.push_back(node.instruction);
+                    if (task.negate) code.push_back({OpCode::NOT, 0});
+                }
+                else if (task.expanded)
+                {
+                    code.push_back({task.negate ? Inverse(op) : op, 0});
+                }
+                else
+                {
+                    // Negation passes through and/or but not into the values being compared
+                    bool logical = op == OpCode::AND || op == OpCode::OR;
+                    tasks.push_back({task.node, task.negate, true});
+                    tasks.push_back({node.right, logical && task.negate, false});
+                    tasks.push_back({node.left, logical && task.negate, false});
+                }
+            }
+            program_->code_.swap(code);
+        }
+
+        static OpCode Inverse(OpCode op)
+        {
+            switch (op)
+            {
+            case OpCode::LT:
+                return OpCode::GE;
+            case OpCode::LE:
+                return OpCode::GT;
+            case OpCode::GT:
+                return OpCode::LE;
+            case OpCode::GE:
+                return OpCode::LT;
+            case OpCode::EQ:
+                return OpCode::NE;
+            case OpCode::NE:
+                return OpCode::EQ;
+            case OpCode::AND:
+                return OpCode::OR;
+            case OpCode::OR:
+                return OpCode::AND;
+            default:
+                return op;
+            }
+        }
+
+        // Bounds recursion for conditions received over RPC
+        bool Nest()
+        {
+            if (++nesting_ <= kMaxNesting) return true;
+            error_ = "condition is too deeply nested";
+            return false;
+        }
+
+        bool PushConstant(double value)
+        {
+            // Constants are addressed by a 16-bit instruction argument
+            if (program_->constants_.size() > UINT16_MAX)
+            {
+                error_ = "condition has too many constants";
+                return false;
+            }
+            program_->constants_.push_back(value);
+            Emit(OpCode::PUSH_CONST, static_cast<uint16_t>(program_->constants_.size() - 1), 1);
+            return true;
+        }
+
+        void Emit(OpCode op, uint16_t arg, int stack_effect)
+        {
+            program_->code_.push_back({op, arg});
+            depth_ += stack_effect;
+            if (depth_ > 0 && static_cast<std::size_t>(depth_) > max_depth_)
+            {
+                max_depth_ = static_cast<std::size_t>(depth_);
+            }
+        }
+
+        char Peek(std::size_t ahead = 0)
+        {
+            SkipSpace();
+            return pos_ + ahead < text_.size() ? text_[pos_ + ahead] : '\0';
+        }
+
+        void SkipSpace()
+        {
+            while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+        }
+
+        bool Accept(const char *token)
+        {
+            SkipSpace();
+            std::size_t length = std::char_traits<char>::length(token);
+            if (text_.compare(pos_, length, token) != 0) return false;
+            pos_ += length;
+            return true;
+        }
+
+        bool AcceptWord(const char *word)
+        {
+            SkipSpace();
+            std::size_t start = pos_;
+            if (ReadWord() == word) return true;
+            pos_ = start;
+            return false;
+        }
+
+        bool Expect(const char *token)
+        {
+            SkipSpace();
+            if (*token == '\0' ? pos_ == text_.size() : Accept(token)) return true;
+            error_ = *token == '\0' ? "unexpected trailing input" : std::string("expected '") + token + "'";
+            return false;
+        }
+
+        std::string ReadWord()
+        {
+            SkipSpace();
+            std::size_t start = pos_;
+            while (pos_ < text_.size() &&
+                   (std::isalnum(static_cast<unsigned char>(text_[pos_])) || text_[pos_] == '_'))
+            {
+                ++pos_;
+            }
+            return text_.substr(start, pos_ - start);
+        }
+
+        static constexpr int kMaxNesting = 32;
+
+        const std::string &text_;
+        Program *program_;
+        int nesting_ = 0;
+        std::size_t pos_ = 0;
+        int depth_ = 0;
+        std::size_t max_depth_ = 0;
+        std::string error_;
+    };
+
+    bool Compile(const std::string &condition, Program *program, std::string *error)
+    {
+        return Compiler(condition, program).Run(error);
+    }
+
+} // namespace Rules
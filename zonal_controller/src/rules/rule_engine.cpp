@@ -0,0 +1,330 @@
+#include "../include/rules/rule_engine.h"
+#include <algorithm>
+#include "../include/logger.hpp"
+
+namespace Rules
+{
+    namespace
+    {
+        // How often the fuel feeder re-checks for shutdown while no samples arrive
+        constexpr std::chrono::milliseconds kFeedPollInterval(200);
+
+        uint64_t NowMs()
+        {
+            auto now = std::chrono::system_clock::now();
+            return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+        }
+    }
+
+    RuleEngine::RuleEngine()
+    {
+        eval_thread_ = std::thread(&RuleEngine::EvalLoop, this);
+    }
+
+    RuleEngine::~RuleEngine()
+    {
+        if (feeding_)
+        {
+            feeding_ = false;
+            fuel_publisher_->unsubscribe(fuel_subscription_.id);
+            feeder_thread_.join();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+            for (auto &watcher : watchers_)
+            {
+                watcher.queue->close();
+            }
+        }
+        cv_.notify_all();
+        eval_thread_.join();
+        LOG_INFO("Rule engine stopped: {} rules, {} evaluations, {} events", rules_.size(), evaluations_, events_);
+    }
+
+    bool RuleEngine::add_rule(const RuleDefinition &definition, std::string *error)
+    {
+        if (definition.id.empty())
+        {
+            if (error) *error = "rule id is empty";
+            return false;
+        }
+
+        auto rule = std::make_unique<Rule>();
+        rule->definition = definition;
+        if (!Compile(definition.condition, &rule->program, error))
+        {
+            return false;
+        }
+        std::size_t instructions = rule->program.size();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = std::find_if(rules_.begin(), rules_.end(),
+                                   [&](const auto &existing) { return existing->definition.id == definition.id; });
+            if (it != rules_.end())
+            {
+                Rule *old = it->get();
+                dirty_.erase(std::remove(dirty_.begin(), dirty_.end(), old), dirty_.end());
+                pending_.erase(std::remove(pending_.begin(), pending_.end(), old), pending_.end());
+                // Watchers only see events, so close out the old rule before the new one can raise
+                if (old->raised) Transition(*old);
+                *it = std::move(rule);
+                MarkDirty(**it);
+            }
+            else
+            {
+                rules_.push_back(std::move(rule));
+                MarkDirty(*rules_.back());
+            }
+            RebuildDependents();
+        }
+        cv_.notify_one();
+
+        LOG_INFO("Rule {} registered: {} ({} instructions)", definition.id, definition.condition, instructions);
+        return true;
+    }
+
+    bool RuleEngine::remove_rule(const std::string &id)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(rules_.begin(), rules_.end(),
+                               [&](const auto &rule) { return rule->definition.id == id; });
+        if (it == rules_.end()) return false;
+
+        Rule *rule = it->get();
+        dirty_.erase(std::remove(dirty_.begin(), dirty_.end(), rule), dirty_.end());
+        pending_.erase(std::remove(pending_.begin(), pending_.end(), rule), pending_.end());
+        if (rule->raised) Transition(*rule);
+        rules_.erase(it);
+        RebuildDependents();
+        LOG_INFO("Rule {} removed", id);
+        return true;
+    }
+
+    void RuleEngine::update(Signal signal, double value)
+    {
+        auto index = static_cast<std::size_t>(signal);
+        uint32_t bit = 1u << index;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if ((known_ & bit) && values_[index] == value) return;
+            values_[index] = value;
+            known_ |= bit;
+            changed_ |= bit;
+        }
+        cv_.notify_one();
+    }
+
+    void RuleEngine::feed_from(Streaming::FuelLevelPublisher &publisher)
+    {
+        // Rules only care about the current value, so conflate
+        Streaming::SubscriptionOptions options;
+        options.policy = Streaming::OverflowPolicy::CONFLATE;
+        options.interval = std::chrono::milliseconds(0);
+
+        fuel_publisher_ = &publisher;
+        fuel_subscription_ = publisher.subscribe(options);
+        feeding_ = true;
+        feeder_thread_ = std::thread(&RuleEngine::FeedLoop, this);
+    }
+
+    std::vector<WatcherStats> RuleEngine::watcher_stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<WatcherStats> stats;
+        stats.reserve(watchers_.size());
+        for (const auto &watcher : watchers_)
+        {
+            stats.push_back({watcher.id, watcher.queue->stats()});
+        }
+        return stats;
+    }
+
+    RuleEngine::Watch RuleEngine::watch(std::vector<std::string> rule_ids, bool include_active)
+    {
+        std::sort(rule_ids.begin(), rule_ids.end());
+        auto queue = std::make_shared<EventQueue>(Streaming::OverflowPolicy::DROP_OLDEST, kWatchQueueDepth);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t id = next_watch_id_++;
+        if (include_active)
+        {
+            for (const auto &rule : rules_)
+            {
+                if (!rule->raised) continue;
+                if (!rule_ids.empty() && !std::binary_search(rule_ids.begin(), rule_ids.end(), rule->definition.id))
+                {
+                    continue;
+                }
+                queue->push(MakeEvent(*rule));
+            }
+        }
+        watchers_.push_back({id, std::move(rule_ids), queue});
+        LOG_DEBUG("Rule watcher {} registered ({} active)", id, watchers_.size());
+        return {id, queue};
+    }
+
+    void RuleEngine::unwatch(uint64_t id)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(watchers_.begin(), watchers_.end(),
+                               [id](const Watcher &watcher) { return watcher.id == id; });
+        if (it == watchers_.end()) return;
+
+        it->queue->close();
+        watchers_.erase(it);
+        LOG_DEBUG("Rule watcher {} removed ({} active)", id, watchers_.size());
+    }
+
+    void RuleEngine::EvalLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_)
+        {
+            auto wake = [this] { return !running_ || changed_ != 0 || !dirty_.empty(); };
+            if (pending_.empty())
+            {
+                cv_.wait(lock, wake);
+            }
+            else
+            {
+                auto deadline = (*std::min_element(pending_.begin(), pending_.end(), [](Rule *a, Rule *b) {
+                                    return a->deadline < b->deadline;
+                                }))->deadline;
+                cv_.wait_until(lock, deadline, wake);
+            }
+            if (!running_) break;
+
+            auto now = std::chrono::steady_clock::now();
+
+            // Every rule reading a changed signal runs once, however many of its signals changed
+            for (std::size_t signal = 0; signal < kSignalCount; ++signal)
+            {
+                if (!(changed_ & (1u << signal))) continue;
+                for (Rule *rule : dependents_[signal])
+                {
+                    MarkDirty(*rule);
+                }
+            }
+            changed_ = 0;
+
+            for (Rule *rule : dirty_)
+            {
+                rule->dirty = false;
+                Evaluate(*rule, now);
+            }
+            dirty_.clear();
+
+            // A pending change that was not cancelled by a re-evaluation has held for its debounce
+            auto expired = std::partition(pending_.begin(), pending_.end(), [now](Rule *rule) {
+                return rule->pending && rule->deadline > now;
+            });
+            for (auto it = expired; it != pending_.end(); ++it)
+            {
+                if (!(*it)->pending) continue;
+                (*it)->pending = false;
+                Transition(**it);
+            }
+            pending_.erase(expired, pending_.end());
+        }
+    }
+
+    void RuleEngine::FeedLoop()
+    {
+        Streaming::FuelSample sample;
+        while (feeding_)
+        {
+            auto result = fuel_subscription_.queue->pop(sample, kFeedPollInterval);
+            if (result == Streaming::PopResult::CLOSED) break;
+            if (result == Streaming::PopResult::ITEM)
+            {
+                update(Signal::FUEL_LEVEL, sample.level_percent);
+            }
+        }
+    }
+
+    void RuleEngine::Evaluate(Rule &rule, std::chrono::steady_clock::time_point now)
+    {
+        // Wait until every signal the rule reads has a value
+        if (rule.program.signal_mask() & ~known_) return;
+
+        ++evaluations_;
+        bool holds = rule.program.evaluate(values_, rule.raised ? rule.definition.hysteresis : 0.0);
+        if (holds == rule.raised)
+        {
+            // Any pending change did not last long enough
+            rule.pending = false;
+            return;
+        }
+
+        if (rule.definition.debounce.count() <= 0)
+        {
+            Transition(rule);
+            return;
+        }
+        if (!rule.pending)
+        {
+            rule.pending = true;
+            rule.deadline = now + rule.definition.debounce;
+            pending_.push_back(&rule);
+        }
+    }
+
+    void RuleEngine::Transition(Rule &rule)
+    {
+        rule.raised = !rule.raised;
+        ++events_;
+
+        RuleEvent event = MakeEvent(rule);
+        LOG_INFO("Rule {} {}", rule.definition.id, rule.raised ? "raised" : "cleared");
+        for (auto &watcher : watchers_)
+        {
+            if (!watcher.rule_ids.empty() &&
+                !std::binary_search(watcher.rule_ids.begin(), watcher.rule_ids.end(), rule.definition.id))
+            {
+                continue;
+            }
+            watcher.queue->push(event);
+        }
+    }
+
+    RuleEvent RuleEngine::MakeEvent(const Rule &rule) const
+    {
+        RuleEvent event;
+        event.rule_id = rule.definition.id;
+        event.raised = rule.raised;
+        event.timestamp_ms = NowMs();
+        event.message = rule.definition.message;
+        event.signals = values_;
+        event.known = known_;
+        return event;
+    }
+
+    void RuleEngine::MarkDirty(Rule &rule)
+    {
+        if (rule.dirty) return;
+        rule.dirty = true;
+        dirty_.push_back(&rule);
+    }
+
+    void RuleEngine::RebuildDependents()
+    {
+        for (auto &list : dependents_)
+        {
+            list.clear();
+        }
+        for (auto &rule : rules_)
+        {
+            for (std::size_t signal = 0; signal < kSignalCount; ++signal)
+            {
+                if (rule->program.signal_mask() & (1u << signal))
+                {
+                    dependents_[signal].push_back(rule.get());
+                }
+            }
+        }
+    }
+
+} // namespace Rules
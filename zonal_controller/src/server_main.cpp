@@ -13,10 +13,23 @@
 #include <atomic>
 #include <thread>
 #include <chrono>
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/health_check_service_interface.h>
 #include "services/obd_service.h"
 #include "services/lighting_service.h"
+#include "services/vehicle_obd_service.h"
+#include "services/vehicle_lighting_service.h"
+#include "aggregator/zone_aggregator.h"
+#include "lanes/execution_lane.h"
+#include "http/sensor_http_server.h"
+#include "obd2/obd2_server.h"
+#include "rules/rule_engine.h"
+#include "services/rule_service.h"
+#include "services/diagnostics_service.h"
+#include "tracing/trace_exporter.h"
 #include "logger.hpp"
 #include "config.hpp"
 
@@ -31,26 +44,31 @@ namespace {
             g_server->Shutdown();
         }
     }
+
+    void traceToggleHandler(int) {
+        Tracing::SetEnabled(!Tracing::Enabled());
+    }
 }
 
 /**
- * @brief Run the gRPC server
+ * @brief Build, start and run the gRPC server for the given services
  *
- * This function:
- * 1. Creates service instances
- * 2. Configures the gRPC server
- * 3. Starts the server
- * 4. Keeps the server running until shutdown
+ * The lighting service is served on the control lane: a completion queue
+ * of its own with dedicated, pinned threads. OBD telemetry stays on the
+ * gRPC-managed thread pools.
  *
- * @note The server runs on port 50051 and listens on all interfaces
+ * @tparam LightingServiceT Async lighting service providing Start(CompletionQueueLane&)
+ * @param obd_service OBD service implementation to register
+ * @param light_service Lighting service implementation to register
+ * @param rule_service Rule service implementation to register
+ * @param diagnostics_service Diagnostics service implementation to register
  */
-void RunServer()
+template <typename LightingServiceT>
+void ServeUntilShutdown(grpc::Service& obd_service, LightingServiceT& light_service, grpc::Service& rule_service,
+                        grpc::Service& diagnostics_service)
 {
     auto& config = zonal_controller::Config::getInstance();
     std::string server_address = config.getServerAddress() + ":" + std::to_string(config.getServerPort());
-    
-    OBD::OBDService obd_service;
-    Body::LightingService light_service;
 
     LOG_INFO("Initializing gRPC server on {}", server_address);
     
@@ -62,26 +80,200 @@ void RunServer()
     // Register the service
     builder.RegisterService(&obd_service);
     builder.RegisterService(&light_service);
+    builder.RegisterService(&rule_service);
+    builder.RegisterService(&diagnostics_service);
+    Lanes::CompletionQueueLane control_lane(config.getControlLane(), builder.AddCompletionQueue());
 
     // Build and start the server
     g_server = builder.BuildAndStart();
+    if (!g_server) {
+        throw std::runtime_error("Failed to start gRPC server on " + server_address);
+    }
+    light_service.Start(control_lane);
+    control_lane.start();
+    Lanes::LatencyReporter latency_reporter(std::chrono::seconds(config.getLaneReportIntervalS()));
     LOG_INFO("OBD Server listening on {}", server_address);
 
     // Keep the server running until shutdown
     while (g_running) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
+
+    // The signal handler has shut the server down; drain the lane's queue
+    control_lane.stop();
+}
+
+/**
+ * @brief Start the HTTP/SSE endpoint if enabled in config.yaml
+ *
+ * @param publisher Fuel level publisher to serve
+ * @param zone_names Zone names reported as source_zone (aggregator mode)
+ * @return std::unique_ptr<Http::SensorHttpServer> Running endpoint, or nullptr if disabled
+ */
+std::unique_ptr<Http::SensorHttpServer> StartHttpEndpoint(Streaming::FuelLevelPublisher& publisher,
+                                                          std::vector<std::string> zone_names = {})
+{
+    auto& config = zonal_controller::Config::getInstance();
+    if (!config.isHttpEnabled()) {
+        return nullptr;
+    }
+
+    Http::HttpServerOptions options;
+    options.address = config.getHttpAddress();
+    options.port = config.getHttpPort();
+    options.max_connections = static_cast<std::size_t>(std::max(1, config.getHttpMaxConnections()));
+    options.vehicle_id = config.getVehicleId();
+    return std::make_unique<Http::SensorHttpServer>(options, publisher, std::move(zone_names));
+}
+
+/**
+ * @brief Start the OBD-II server on the CAN bus if enabled in config.yaml
+ *
+ * A missing CAN interface is logged rather than fatal, so the gRPC
+ * services still come up on hosts without one.
+ *
+ * @param source Vehicle state to answer from
+ * @return std::unique_ptr<Obd2::Obd2Server> Running server, or nullptr if disabled or unavailable
+ */
+std::unique_ptr<Obd2::Obd2Server> StartObd2Server(const Obd2::VehicleStateSource& source)
+{
+    auto& config = zonal_controller::Config::getInstance();
+    if (!config.isObd2Enabled()) {
+        return nullptr;
+    }
+
+    Obd2::Obd2ServerOptions options;
+    options.interface = config.getObd2Interface();
+    options.request_id = static_cast<uint32_t>(config.getObd2RequestId());
+    options.functional_id = static_cast<uint32_t>(config.getObd2FunctionalId());
+    options.response_id = static_cast<uint32_t>(config.getObd2ResponseId());
+    options.iso_tp.padding = config.isObd2Padding();
+    options.iso_tp.padding_byte = static_cast<uint8_t>(config.getObd2PaddingByte());
+    try {
+        return std::make_unique<Obd2::Obd2Server>(options, source);
+    } catch (const std::exception& e) {
+        LOG_ERROR("OBD-II server not started: {}", e.what());
+        return nullptr;
+    }
+}
+
+/**
+ * @brief Register the rules from config.yaml with the engine
+ *
+ * Rules that do not compile are logged and skipped.
+ *
+ * @param engine Rule engine to load
+ */
+void LoadRules(Rules::RuleEngine& engine)
+{
+    for (const auto& rule : zonal_controller::Config::getInstance().getRules()) {
+        Rules::RuleDefinition definition;
+        definition.id = rule.id;
+        definition.condition = rule.condition;
+        definition.hysteresis = rule.hysteresis;
+        definition.debounce = std::chrono::milliseconds(std::max(0, rule.debounceMs));
+        definition.message = rule.message;
+
+        std::string error;
+        if (!engine.add_rule(definition, &error)) {
+            LOG_ERROR("Skipping rule {} from config: {}", rule.id, error);
+        }
+    }
+}
+
+/**
+ * @brief Start resource sampling over the given components
+ *
+ * @param sources Components to report on
+ * @return std::unique_ptr<Diagnostics::ResourceSampler> Running sampler
+ */
+std::unique_ptr<Diagnostics::ResourceSampler> StartResourceSampler(const Diagnostics::SamplerSources& sources)
+{
+    auto& config = zonal_controller::Config::getInstance();
+    return std::make_unique<Diagnostics::ResourceSampler>(
+        std::chrono::milliseconds(std::max(100, config.getDiagnosticsSampleIntervalMs())),
+        static_cast<std::size_t>(std::max(1, config.getDiagnosticsHistory())), sources);
+}
+
+/**
+ * @brief Run the gRPC server
+ *
+ * This function:
+ * 1. Creates service instances
+ * 2. Configures the gRPC server
+ * 3. Starts the server
+ * 4. Keeps the server running until shutdown
+ *
+ * In aggregator mode the services answer for the whole vehicle by fanning
+ * in the zone controllers listed in config.yaml.
+ *
+ * @param aggregator_mode Serve as a vehicle-level aggregator
+ * @note The server listens on the address and port from config.yaml
+ */
+void RunServer(bool aggregator_mode)
+{
+    auto& config = zonal_controller::Config::getInstance();
+
+    if (aggregator_mode) {
+        Aggregator::ZoneAggregator aggregator(
+            config.getZones(),
+            std::chrono::milliseconds(config.getStreamSampleIntervalMs()),
+            std::chrono::milliseconds(config.getAggregatorReorderWindowMs()),
+            std::chrono::milliseconds(config.getAggregatorRpcTimeoutMs()));
+        Aggregator::VehicleOBDService obd_service(aggregator);
+        Rules::RuleEngine rules;
+        LoadRules(rules);
+        rules.feed_from(aggregator.publisher());
+        Aggregator::VehicleLightingService light_service(aggregator, rules);
+        Rules::RuleService rule_service(rules);
+        auto http_endpoint = StartHttpEndpoint(aggregator.publisher(), aggregator.zone_names());
+        auto obd2_server = StartObd2Server(obd_service.vehicle_state());
+        auto sampler = StartResourceSampler({&aggregator.publisher(), &rules, http_endpoint.get()});
+        Diagnostics::DiagnosticsService diagnostics_service(*sampler);
+        ServeUntilShutdown(obd_service, light_service, rule_service, diagnostics_service);
+        return;
+    }
+
+    OBD::OBDService obd_service;
+    Rules::RuleEngine rules;
+    LoadRules(rules);
+    rules.feed_from(obd_service.publisher());
+    Body::LightingService light_service(rules);
+    Rules::RuleService rule_service(rules);
+    auto http_endpoint = StartHttpEndpoint(obd_service.publisher());
+    auto obd2_server = StartObd2Server(obd_service.vehicle_state());
+    auto sampler = StartResourceSampler({&obd_service.publisher(), &rules, http_endpoint.get()});
+    Diagnostics::DiagnosticsService diagnostics_service(*sampler);
+    ServeUntilShutdown(obd_service, light_service, rule_service, diagnostics_service);
 }
 
 /**
  * @brief Main entry point
  *
+ * Supported options:
+ * - `--config <path>`: configuration file (default: config.yaml)
+ * - `--aggregator`: run as a vehicle-level aggregator regardless of config.yaml
+ *
  * @param argc Number of command line arguments
  * @param argv Command line arguments
  * @return int Exit code (0 on success)
  */
 int main(int argc, char **argv)
 {
+    std::string config_path = "config.yaml";
+    bool aggregator_flag = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--config" && i + 1 < argc) {
+            config_path = argv[++i];
+        } else if (arg == "--aggregator") {
+            aggregator_flag = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--config <path>] [--aggregator]" << std::endl;
+            return 1;
+        }
+    }
+
     // Initialize logging
     auto& logger = zonal_controller::Logger::getInstance();
     logger.setLogLevel(zonal_controller::LogLevel::DEBUG);
@@ -89,17 +281,27 @@ int main(int argc, char **argv)
     
     // Load configuration
     auto& config = zonal_controller::Config::getInstance();
-    if (!config.loadConfig("config.yaml")) {
+    if (!config.loadConfig(config_path)) {
         LOG_ERROR("Failed to load configuration. Using defaults.");
     }
 
+    // Spans are buffered per thread and written out by the exporter; SIGUSR2 toggles recording
+    Tracing::SetBufferCapacity(static_cast<std::size_t>(std::max(1, config.getTracingBufferSpans())));
+    Tracing::ExporterOptions trace_options;
+    trace_options.output_dir = config.getTracingOutputDir();
+    trace_options.interval = std::chrono::milliseconds(std::max(10, config.getTracingExportIntervalMs()));
+    trace_options.max_files = static_cast<std::size_t>(std::max(0, config.getTracingMaxFiles()));
+    Tracing::TraceExporter trace_exporter(trace_options);
+    Tracing::SetEnabled(config.isTracingEnabled());
+
     // Set up signal handlers
     std::signal(SIGINT, signalHandler);
     std::signal(SIGTERM, signalHandler);
+    std::signal(SIGUSR2, traceToggleHandler);
     
     LOG_INFO("Starting Zonal Controller Server");
     try {
-        RunServer();
+        RunServer(aggregator_flag || config.isAggregatorEnabled());
     } catch (const std::exception& e) {
         LOG_ERROR("Server error: {}", e.what());
         return 1;
@@ -0,0 +1,115 @@
+#include "../include/services/diagnostics_service.h"
+#include <algorithm>
+#include "../include/logger.hpp"
+
+namespace Diagnostics
+{
+    namespace
+    {
+        constexpr uint32_t kMaxCaptureSeconds = 60;
+        constexpr uint32_t kDefaultFrequencyHz = 99;
+        constexpr uint32_t kMaxFrequencyHz = 1000;
+        constexpr uint32_t kDefaultMaxEntries = 50;
+
+        void FillSample(const ResourceSample &sample, diagnostics::ResourceSample *out)
+        {
+            out->set_timestamp_ms(sample.timestamp_ms);
+            out->set_cpu_percent(sample.cpu_percent);
+            out->set_rss_bytes(sample.rss_bytes);
+            out->set_vm_bytes(sample.vm_bytes);
+            out->set_heap_in_use_bytes(sample.heap_in_use_bytes);
+            out->set_allocations(sample.allocations.allocations);
+            out->set_frees(sample.allocations.frees);
+            out->set_allocated_bytes(sample.allocations.allocated_bytes);
+            out->set_freed_bytes(sample.allocations.freed_bytes);
+            out->set_fuel_subscribers(static_cast<uint32_t>(sample.fuel_subscribers));
+            out->set_rule_watchers(static_cast<uint32_t>(sample.rule_watchers));
+            out->set_http_streams(static_cast<uint32_t>(sample.http_streams));
+            out->set_logger_backlog(static_cast<uint32_t>(std::max(0, sample.logger_backlog)));
+
+            for (const auto &queue : sample.queues)
+            {
+                auto *depth = out->add_queues();
+                depth->set_name(queue.name);
+                depth->set_depth(static_cast<uint32_t>(queue.depth));
+                depth->set_capacity(static_cast<uint32_t>(queue.capacity));
+                depth->set_dropped(queue.dropped);
+            }
+            for (const auto &thread : sample.threads)
+            {
+                auto *usage = out->add_threads();
+                usage->set_tid(thread.tid);
+                usage->set_name(thread.name);
+                usage->set_cpu_percent(thread.cpu_percent);
+                usage->set_cpu_time_ms(thread.cpu_time_ms);
+            }
+        }
+
+        void FillEntries(const std::vector<ProfileEntry> &entries,
+                         google::protobuf::RepeatedPtrField<diagnostics::ProfileEntry> *out)
+        {
+            for (const auto &entry : entries)
+            {
+                auto *added = out->Add();
+                added->set_name(entry.name);
+                added->set_samples(entry.samples);
+            }
+        }
+    }
+
+    DiagnosticsService::DiagnosticsService(ResourceSampler &sampler) : sampler_(sampler)
+    {
+        LOG_INFO("Initializing diagnostics service");
+        SetMessageAllocatorFor_GetSamples(&samples_allocator_);
+    }
+
+    grpc::ServerUnaryReactor *DiagnosticsService::GetSamples(grpc::CallbackServerContext *context,
+                                                             const diagnostics::GetSamplesRequest *request,
+                                                             diagnostics::GetSamplesResponse *response)
+    {
+        grpc::ServerUnaryReactor *reactor = context->DefaultReactor();
+        for (const auto &sample : sampler_.recent(request->max_samples()))
+        {
+            FillSample(sample, response->add_samples());
+        }
+        response->set_sample_interval_ms(static_cast<uint32_t>(sampler_.interval().count()));
+        reactor->Finish(grpc::Status::OK);
+        return reactor;
+    }
+
+    grpc::Status DiagnosticsService::CaptureProfile(grpc::ServerContext *context,
+                                                    const diagnostics::CaptureProfileRequest *request,
+                                                    diagnostics::CaptureProfileResponse *response)
+    {
+        if (request->duration_s() == 0 || request->duration_s() > kMaxCaptureSeconds)
+        {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                "duration_s must be between 1 and " + std::to_string(kMaxCaptureSeconds));
+        }
+        uint32_t frequency = request->frequency_hz() ? std::min(request->frequency_hz(), kMaxFrequencyHz)
+                                                     : kDefaultFrequencyHz;
+        uint32_t max_entries = request->max_entries() ? request->max_entries() : kDefaultMaxEntries;
+        LOG_INFO("Received CaptureProfile request: {} s at {} Hz", request->duration_s(), frequency);
+
+        ProfileResult result;
+        std::string error;
+        CaptureStatus status =
+            profiler_.capture(std::chrono::seconds(request->duration_s()), static_cast<int>(frequency), max_entries,
+                              [context] { return context->IsCancelled(); }, &result, &error);
+        if (status != CaptureStatus::OK)
+        {
+            LOG_WARNING("Profile capture failed: {}", error);
+            return grpc::Status(status == CaptureStatus::BUSY ? grpc::StatusCode::ABORTED
+                                                              : grpc::StatusCode::FAILED_PRECONDITION,
+                                error);
+        }
+
+        response->set_samples(result.samples);
+        response->set_lost(result.lost);
+        FillEntries(result.functions, response->mutable_functions());
+        FillEntries(result.stacks, response->mutable_stacks());
+        FillEntries(result.threads, response->mutable_threads());
+        return grpc::Status::OK;
+    }
+
+} // namespace Diagnostics
@@ -3,67 +3,98 @@
 
 namespace Body
 {
+  namespace
+  {
+    // Calls each method can have in flight on the control lane
+    constexpr std::size_t kSlotsPerMethod = 4;
+  }
 
-  LightingService::LightingService() : body_lights_()
+  LightingService::LightingService(Rules::RuleEngine &rules) : body_lights_(), rules_(rules)
   {
     LOG_INFO("Initializing Lighting service");
+    rules_.update(Rules::Signal::HEADLIGHTS, body_lights_.get_headlight_state() ? 1.0 : 0.0);
   }
 
-  grpc::Status LightingService::GetHeadlightState(
-      grpc::ServerContext *context,
-      const lighting::GetHeadlightStateRequest *request,
-      lighting::GetHeadlightStateResponse *response)
+  void LightingService::Start(Lanes::CompletionQueueLane &lane)
+  {
+    GetStateCall::Spawn(
+        "LightingService.GetHeadlightState", lane, kSlotsPerMethod,
+        [this](grpc::ServerContext *context, lighting::GetHeadlightStateRequest *request,
+               grpc::ServerAsyncResponseWriter<lighting::GetHeadlightStateResponse> *responder,
+               grpc::ServerCompletionQueue *cq, void *tag)
+        { RequestGetHeadlightState(context, request, responder, cq, cq, tag); },
+        [this](GetStateCall &call) { GetHeadlightState(call); });
+
+    SetHeadlightCall::Spawn(
+        "LightingService.SetHeadlight", lane, kSlotsPerMethod,
+        [this](grpc::ServerContext *context, lighting::SetHeadlightRequest *request,
+               grpc::ServerAsyncResponseWriter<lighting::SetHeadlightResponse> *responder,
+               grpc::ServerCompletionQueue *cq, void *tag)
+        { RequestSetHeadlight(context, request, responder, cq, cq, tag); },
+        [this](SetHeadlightCall &call) { SetHeadlight(call); });
+  }
+
+  void LightingService::GetHeadlightState(GetStateCall &call)
   {
     try
     {
       LOG_DEBUG("Received GetHeadlightState request");
       // Call the embedded function to get state
-      bool state = body_lights_.get_headlight_state();
+      bool state;
+      {
+        TRACE_SPAN("BodyLights.get_headlight_state");
+        std::lock_guard<std::mutex> lock(lights_mutex_);
+        state = body_lights_.get_headlight_state();
+      }
 
       // Convert to boolean and set response
-      response->set_is_on(state == 1);
+      call.response()->set_is_on(state == 1);
       LOG_INFO("Headlight state: {}", state ? "ON" : "OFF");
 
-      return grpc::Status::OK;
+      call.Finish(grpc::Status::OK);
     }
     catch (const std::exception &e)
     {
       LOG_ERROR("Error getting headlight state: {}", e.what());
       // Handle any exceptions
-      return grpc::Status(grpc::StatusCode::INTERNAL, e.what());
+      call.Finish(grpc::Status(grpc::StatusCode::INTERNAL, e.what()));
     }
   }
 
-  grpc::Status LightingService::SetHeadlight(
-      grpc::ServerContext *context,
-      const lighting::SetHeadlightRequest *request,
-      lighting::SetHeadlightResponse *response)
+  void LightingService::SetHeadlight(SetHeadlightCall &call)
   {
+    const lighting::SetHeadlightRequest &request = call.request();
     try
     {
-      LOG_DEBUG("Received SetHeadlight request: {}", request->turn_on() ? "ON" : "OFF");
+      LOG_DEBUG("Received SetHeadlight request: {}", request.turn_on() ? "ON" : "OFF");
       // Convert boolean to int (1 = ON, 0 = OFF)
-      bool state_to_set = request->turn_on() ? 1 : 0;
+      bool state_to_set = request.turn_on() ? 1 : 0;
 
       // Call the embedded function to set state
-      bool result = body_lights_.set_headlight(state_to_set);
+      bool result;
+      {
+        TRACE_SPAN("BodyLights.set_headlight");
+        std::lock_guard<std::mutex> lock(lights_mutex_);
+        result = body_lights_.set_headlight(state_to_set);
+      }
 
       // Set response based on result
-      response->set_success(result == 1);
-      
+      call.response()->set_success(result == 1);
+
       if (result) {
         LOG_INFO("Successfully set headlight state to: {}", state_to_set ? "ON" : "OFF");
+        rules_.update(Rules::Signal::HEADLIGHTS, state_to_set ? 1.0 : 0.0);
       } else {
         LOG_WARNING("Failed to set headlight state to: {}", state_to_set ? "ON" : "OFF");
       }
 
-      return grpc::Status::OK;
+      call.Finish(grpc::Status::OK);
     }
     catch (const std::exception &e)
     {
       LOG_ERROR("Error setting headlight state: {}", e.what());
       // Handle any exceptions
-      return grpc::Status(grpc::StatusCode::INTERNAL, e.what());
+      call.Finish(grpc::Status(grpc::StatusCode::INTERNAL, e.what()));
     }
   }
 }
@@ -1,28 +1,77 @@
 #include "../include/services/obd_service.h"
+#include <algorithm>
 #include <thread>
 #include <ctime>
+#include "../include/config.hpp"
+#include "../include/lanes/execution_lane.h"
+#include "../include/obd2/pid_query.h"
+#include "../include/streaming/fuel_stream.h"
+#include "../include/tracing/trace_context.h"
 #include "../include/logger.hpp"
 
 namespace OBD
 {
+    namespace
+    {
+        uint64_t NowMs()
+        {
+            auto now = std::chrono::system_clock::now();
+            auto now_ms = std::chrono::time_point_cast<std::chrono::milliseconds>(now);
+            return now_ms.time_since_epoch().count();
+        }
+    }
 
-    OBDService::OBDService() : fuel_sensor_(75.0f, 0.01f)
+    OBDService::OBDService()
+        : fuel_sensor_(75.0f, 0.01f),
+          publisher_(std::chrono::milliseconds(
+              std::max(1, zonal_controller::Config::getInstance().getStreamSampleIntervalMs()))),
+          sample_period_(std::max(1, zonal_controller::Config::getInstance().getStreamSampleIntervalMs())),
+          vehicle_state_(publisher_, zonal_controller::Config::getInstance().getObd2Vin(),
+                         zonal_controller::Config::getInstance().getObd2EcuName())
     {
         LOG_INFO("Initializing OBD service with default fuel level: {}%", 75.0f);
+        SetMessageAllocatorFor_GetFuelLevel(&fuel_level_allocator_);
+        SetMessageAllocatorFor_QueryPids(&query_pids_allocator_);
+
+        // Publish one sample up front so unary reads never see an empty cache
+        publisher_.publish({fuel_sensor_.read_fuel_level(), NowMs()});
+        sampler_thread_ = std::thread(&OBDService::SampleLoop, this);
+        LOG_INFO("Fuel level sampler started with period: {} ms", static_cast<long>(sample_period_.count()));
+    }
+
+    OBDService::~OBDService()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sampler_mutex_);
+            running_ = false;
+        }
+        sampler_cv_.notify_all();
+        if (sampler_thread_.joinable())
+        {
+            sampler_thread_.join();
+        }
     }
 
-    grpc::Status OBDService::GetFuelLevel(grpc::ServerContext *context,
-                                          const obd::FuelLevelRequest *request,
-                                          obd::FuelLevelResponse *response)
+    grpc::ServerUnaryReactor *OBDService::GetFuelLevel(grpc::CallbackServerContext *context,
+                                                       const obd::FuelLevelRequest *request,
+                                                       obd::FuelLevelResponse *response)
     {
+        grpc::ServerUnaryReactor *reactor = context->DefaultReactor();
+        auto started = Lanes::CallStarted(*context);
+        Tracing::ScopedTrace trace(*context);
+        TRACE_SPAN("OBDService.GetFuelLevel");
         try
         {
             LOG_DEBUG("Received GetFuelLevel request");
-            // Read the fuel level from the sensor
-            float level = fuel_sensor_.read_fuel_level();
-            *response = CreateFuelLevelResponse(level);
-            LOG_INFO("Fuel level read: {}%", level);
-            return grpc::Status::OK;
+            // Serve the latest sample taken by the sampler
+            Streaming::FuelSample sample = publisher_.latest();
+            {
+                TRACE_SPAN("FillFuelLevelResponse");
+                Streaming::FillFuelLevelResponse(sample, {}, response);
+            }
+            LOG_INFO("Fuel level read: {}%", sample.level_percent);
+            Lanes::Histogram(Lanes::Lane::TELEMETRY).record(std::chrono::steady_clock::now() - started);
+            reactor->Finish(grpc::Status::OK);
         }
         catch (const std::exception &e)
         {
@@ -30,65 +79,56 @@ namespace OBD
             // Handle any exceptions
             response->set_status(1);
             response->set_error_message(e.what());
-            return grpc::Status(grpc::StatusCode::INTERNAL, e.what());
+            reactor->Finish(grpc::Status(grpc::StatusCode::INTERNAL, e.what()));
         }
+        return reactor;
     }
 
     grpc::Status OBDService::StreamFuelLevel(grpc::ServerContext *context,
                                              const obd::FuelLevelStreamRequest *request,
                                              grpc::ServerWriter<obd::FuelLevelResponse> *writer)
     {
-        LOG_INFO("Starting fuel level stream with interval: {} seconds", request->interval_seconds());
-        // Get the requested interval (default to 1 second if 0)
-        uint32_t interval_seconds = request->interval_seconds();
-        if (interval_seconds == 0)
+        return Streaming::ServeFuelStream(publisher_, context, *request, writer);
+    }
+
+    grpc::ServerUnaryReactor *OBDService::QueryPids(grpc::CallbackServerContext *context,
+                                                    const obd::QueryPidsRequest *request,
+                                                    obd::QueryPidsResponse *response)
+    {
+        grpc::ServerUnaryReactor *reactor = context->DefaultReactor();
+        auto started = Lanes::CallStarted(*context);
+        Tracing::ScopedTrace trace(*context);
+        TRACE_SPAN("OBDService.QueryPids");
+        LOG_DEBUG("Received QueryPids request with {} queries", request->queries_size());
+
+        grpc::Status status = Obd2::FillQueryPidsResponse(vehicle_state_.snapshot(), *request, response);
+        if (!status.ok())
         {
-            interval_seconds = 1;
-            LOG_WARNING("Stream interval was 0, defaulting to 1 second");
+            LOG_WARNING("Rejected QueryPids request: {}", status.error_message());
         }
+        Lanes::Histogram(Lanes::Lane::TELEMETRY).record(std::chrono::steady_clock::now() - started);
+        reactor->Finish(status);
+        return reactor;
+    }
 
-        // Stream fuel level updates until client disconnects
-        while (!context->IsCancelled())
+    void OBDService::SampleLoop()
+    {
+        Lanes::EnterLane(Lanes::Lane::TELEMETRY);
+        auto next_sample = std::chrono::steady_clock::now() + sample_period_;
+        std::unique_lock<std::mutex> lock(sampler_mutex_);
+        while (!sampler_cv_.wait_until(lock, next_sample, [this] { return !running_; }))
         {
-            obd::FuelLevelResponse response;
-
+            lock.unlock();
             {
+                TRACE_SPAN("FuelLevelSensor.read");
                 float level = fuel_sensor_.read_fuel_level();
-                response = CreateFuelLevelResponse(level);
-                LOG_DEBUG("Streaming fuel level: {}%", level);
-            }
-
-            // Write the response to the stream
-            if (!writer->Write(response))
-            {
-                LOG_INFO("Client disconnected from fuel level stream");
-                break;
+                TRACE_SPAN("FuelLevelPublisher.publish");
+                publisher_.publish({level, NowMs()});
             }
+            lock.lock();
 
-            // Wait for the specified interval
-            std::this_thread::sleep_for(std::chrono::seconds(interval_seconds));
+            next_sample += sample_period_;
         }
-
-        return grpc::Status::OK;
-    }
-
-    obd::FuelLevelResponse OBDService::CreateFuelLevelResponse(float level)
-    {
-        obd::FuelLevelResponse response;
-
-        // Set the fuel level
-        response.set_level_percent(level);
-
-        // Set the current timestamp in milliseconds
-        auto now = std::chrono::system_clock::now();
-        auto now_ms = std::chrono::time_point_cast<std::chrono::milliseconds>(now);
-        auto value = now_ms.time_since_epoch().count();
-        response.set_timestamp_ms(value);
-
-        // Set status to OK
-        response.set_status(0);
-
-        return response;
     }
 
 } // namespace OBD
@@ -0,0 +1,115 @@
+#include "../include/services/rule_service.h"
+#include "../include/logger.hpp"
+
+namespace Rules
+{
+    namespace
+    {
+        // How long a watch handler waits for an event before re-checking cancellation
+        constexpr std::chrono::milliseconds kWatchPollInterval(200);
+
+        void FillRuleEvent(const RuleEvent &event, rules::RuleEvent *response)
+        {
+            response->set_rule_id(event.rule_id);
+            response->set_type(event.raised ? rules::RULE_RAISED : rules::RULE_CLEARED);
+            response->set_timestamp_ms(event.timestamp_ms);
+            response->set_message(event.message);
+
+            auto *signals = response->mutable_signals();
+            signals->clear();
+            for (std::size_t i = 0; i < kSignalCount; ++i)
+            {
+                if (event.known & (1u << i))
+                {
+                    (*signals)[SignalName(static_cast<Signal>(i))] = event.signals[i];
+                }
+            }
+        }
+    }
+
+    RuleService::RuleService(RuleEngine &engine) : engine_(engine)
+    {
+        LOG_INFO("Initializing rule service");
+        SetMessageAllocatorFor_RegisterRule(&register_allocator_);
+        SetMessageAllocatorFor_RemoveRule(&remove_allocator_);
+    }
+
+    grpc::ServerUnaryReactor *RuleService::RegisterRule(grpc::CallbackServerContext *context,
+                                                        const rules::RegisterRuleRequest *request,
+                                                        rules::RegisterRuleResponse *response)
+    {
+        grpc::ServerUnaryReactor *reactor = context->DefaultReactor();
+        const rules::Rule &rule = request->rule();
+        LOG_DEBUG("Received RegisterRule request: {}", rule.id());
+
+        RuleDefinition definition;
+        definition.id = rule.id();
+        definition.condition = rule.condition();
+        definition.hysteresis = rule.hysteresis();
+        definition.debounce = std::chrono::milliseconds(rule.debounce_ms());
+        definition.message = rule.message();
+
+        std::string error;
+        if (!engine_.add_rule(definition, &error))
+        {
+            LOG_WARNING("Rejected rule {}: {}", rule.id(), error);
+            response->set_success(false);
+            response->set_error_message(error);
+            reactor->Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, error));
+            return reactor;
+        }
+
+        response->set_success(true);
+        reactor->Finish(grpc::Status::OK);
+        return reactor;
+    }
+
+    grpc::ServerUnaryReactor *RuleService::RemoveRule(grpc::CallbackServerContext *context,
+                                                      const rules::RemoveRuleRequest *request,
+                                                      rules::RemoveRuleResponse *response)
+    {
+        grpc::ServerUnaryReactor *reactor = context->DefaultReactor();
+        LOG_DEBUG("Received RemoveRule request: {}", request->rule_id());
+        response->set_success(engine_.remove_rule(request->rule_id()));
+        reactor->Finish(grpc::Status::OK);
+        return reactor;
+    }
+
+    grpc::Status RuleService::WatchEvents(grpc::ServerContext *context, const rules::WatchEventsRequest *request,
+                                          grpc::ServerWriter<rules::RuleEvent> *writer)
+    {
+        std::vector<std::string> rule_ids(request->rule_ids().begin(), request->rule_ids().end());
+        auto watch = engine_.watch(std::move(rule_ids), request->include_active());
+        LOG_INFO("Rule watcher {} started ({} rules)", watch.id,
+                 request->rule_ids_size() ? std::to_string(request->rule_ids_size()) : std::string("all"));
+
+        // Events are rare, so one reused message is plenty
+        rules::RuleEvent response;
+        RuleEvent event;
+        while (!context->IsCancelled())
+        {
+            auto result = watch.queue->pop(event, kWatchPollInterval);
+            if (result == Streaming::PopResult::TIMEOUT)
+            {
+                continue;
+            }
+            if (result == Streaming::PopResult::CLOSED)
+            {
+                break;
+            }
+
+            FillRuleEvent(event, &response);
+            if (!writer->Write(response))
+            {
+                LOG_INFO("Client disconnected from rule watcher {}", watch.id);
+                break;
+            }
+        }
+
+        Streaming::QueueStats stats = watch.queue->stats();
+        engine_.unwatch(watch.id);
+        LOG_INFO("Rule watcher {} closed: delivered {}, dropped {}", watch.id, stats.delivered, stats.dropped);
+        return grpc::Status::OK;
+    }
+
+} // namespace Rules
@@ -0,0 +1,72 @@
+#include "../include/services/vehicle_lighting_service.h"
+#include "../include/logger.hpp"
+
+namespace Aggregator
+{
+  namespace
+  {
+    // Forwarded calls wait on a zone, so allow more in flight than a zone does
+    constexpr std::size_t kSlotsPerMethod = 16;
+  }
+
+  VehicleLightingService::VehicleLightingService(ZoneAggregator &aggregator, Rules::RuleEngine &rules)
+      : aggregator_(aggregator), rules_(rules)
+  {
+    LOG_INFO("Initializing vehicle lighting service");
+  }
+
+  void VehicleLightingService::Start(Lanes::CompletionQueueLane &lane)
+  {
+    GetStateCall::Spawn(
+        "VehicleLightingService.GetHeadlightState", lane, kSlotsPerMethod,
+        [this](grpc::ServerContext *context, lighting::GetHeadlightStateRequest *request,
+               grpc::ServerAsyncResponseWriter<lighting::GetHeadlightStateResponse> *responder,
+               grpc::ServerCompletionQueue *cq, void *tag)
+        { RequestGetHeadlightState(context, request, responder, cq, cq, tag); },
+        [this](GetStateCall &call) { GetHeadlightState(call); });
+
+    SetHeadlightCall::Spawn(
+        "VehicleLightingService.SetHeadlight", lane, kSlotsPerMethod,
+        [this](grpc::ServerContext *context, lighting::SetHeadlightRequest *request,
+               grpc::ServerAsyncResponseWriter<lighting::SetHeadlightResponse> *responder,
+               grpc::ServerCompletionQueue *cq, void *tag)
+        { RequestSetHeadlight(context, request, responder, cq, cq, tag); },
+        [this](SetHeadlightCall &call) { SetHeadlight(call); });
+  }
+
+  void VehicleLightingService::GetHeadlightState(GetStateCall &call)
+  {
+    ZoneClient &zone = aggregator_.owner_of("headlights");
+    LOG_DEBUG("Routing GetHeadlightState to zone {}", zone.name());
+
+    zone.GetHeadlightState(call.response(), [this, &call, &zone](grpc::Status status) {
+      if (!status.ok())
+      {
+        LOG_ERROR("Zone {} failed GetHeadlightState: {}", zone.name(), status.error_message());
+      }
+      else
+      {
+        rules_.update(Rules::Signal::HEADLIGHTS, call.response()->is_on() ? 1.0 : 0.0);
+      }
+      call.Finish(status);
+    });
+  }
+
+  void VehicleLightingService::SetHeadlight(SetHeadlightCall &call)
+  {
+    ZoneClient &zone = aggregator_.owner_of("headlights");
+    LOG_DEBUG("Routing SetHeadlight {} to zone {}", call.request().turn_on() ? "ON" : "OFF", zone.name());
+
+    zone.SetHeadlight(&call.request(), call.response(), [this, &call, &zone](grpc::Status status) {
+      if (!status.ok())
+      {
+        LOG_ERROR("Zone {} failed SetHeadlight: {}", zone.name(), status.error_message());
+      }
+      else if (call.response()->success())
+      {
+        rules_.update(Rules::Signal::HEADLIGHTS, call.request().turn_on() ? 1.0 : 0.0);
+      }
+      call.Finish(status);
+    });
+  }
+}
@@ -0,0 +1,81 @@
+#include "../include/services/vehicle_obd_service.h"
+#include "../include/config.hpp"
+#include "../include/lanes/execution_lane.h"
+#include "../include/obd2/pid_query.h"
+#include "../include/streaming/fuel_stream.h"
+#include "../include/tracing/trace_context.h"
+#include "../include/logger.hpp"
+
+namespace Aggregator
+{
+
+    VehicleOBDService::VehicleOBDService(ZoneAggregator &aggregator)
+        : aggregator_(aggregator),
+          vehicle_state_(aggregator.publisher(), zonal_controller::Config::getInstance().getObd2Vin(),
+                         zonal_controller::Config::getInstance().getObd2EcuName())
+    {
+        LOG_INFO("Initializing vehicle OBD service");
+        SetMessageAllocatorFor_GetFuelLevel(&fuel_level_allocator_);
+        SetMessageAllocatorFor_QueryPids(&query_pids_allocator_);
+    }
+
+    grpc::ServerUnaryReactor *VehicleOBDService::GetFuelLevel(grpc::CallbackServerContext *context,
+                                                              const obd::FuelLevelRequest *request,
+                                                              obd::FuelLevelResponse *response)
+    {
+        grpc::ServerUnaryReactor *reactor = context->DefaultReactor();
+        auto started = Lanes::CallStarted(*context);
+        Tracing::ScopedTrace trace(*context);
+        TRACE_SPAN("VehicleOBDService.GetFuelLevel");
+        LOG_DEBUG("Received GetFuelLevel request");
+        ZoneClient &zone = aggregator_.owner_of("fuel");
+
+        Streaming::FuelSample sample;
+        if (!zone.latest(&sample))
+        {
+            LOG_WARNING("No fuel level received yet from zone {}", zone.name());
+            response->set_status(1);
+            response->set_error_message("No fuel level received yet from zone " + zone.name());
+            reactor->Finish(grpc::Status(grpc::StatusCode::UNAVAILABLE, response->error_message()));
+            return reactor;
+        }
+
+        {
+            TRACE_SPAN("FillFuelLevelResponse");
+            Streaming::FillFuelLevelResponse(sample, aggregator_.zone_names(), response);
+        }
+        LOG_INFO("Fuel level from zone {}: {}%", zone.name(), sample.level_percent);
+        Lanes::Histogram(Lanes::Lane::TELEMETRY).record(std::chrono::steady_clock::now() - started);
+        reactor->Finish(grpc::Status::OK);
+        return reactor;
+    }
+
+    grpc::Status VehicleOBDService::StreamFuelLevel(grpc::ServerContext *context,
+                                                    const obd::FuelLevelStreamRequest *request,
+                                                    grpc::ServerWriter<obd::FuelLevelResponse> *writer)
+    {
+        return Streaming::ServeFuelStream(aggregator_.publisher(), context, *request, writer,
+                                          aggregator_.zone_names());
+    }
+
+    grpc::ServerUnaryReactor *VehicleOBDService::QueryPids(grpc::CallbackServerContext *context,
+                                                           const obd::QueryPidsRequest *request,
+                                                           obd::QueryPidsResponse *response)
+    {
+        grpc::ServerUnaryReactor *reactor = context->DefaultReactor();
+        auto started = Lanes::CallStarted(*context);
+        Tracing::ScopedTrace trace(*context);
+        TRACE_SPAN("VehicleOBDService.QueryPids");
+        LOG_DEBUG("Received QueryPids request with {} queries", request->queries_size());
+
+        grpc::Status status = Obd2::FillQueryPidsResponse(vehicle_state_.snapshot(), *request, response);
+        if (!status.ok())
+        {
+            LOG_WARNING("Rejected QueryPids request: {}", status.error_message());
+        }
+        Lanes::Histogram(Lanes::Lane::TELEMETRY).record(std::chrono::steady_clock::now() - started);
+        reactor->Finish(status);
+        return reactor;
+    }
+
+} // namespace Aggregator
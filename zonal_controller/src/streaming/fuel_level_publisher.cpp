@@ -0,0 +1,123 @@
+#include "../include/streaming/fuel_level_publisher.h"
+#include <algorithm>
+#include "../include/logger.hpp"
+
+namespace Streaming
+{
+    FuelLevelPublisher::FuelLevelPublisher(std::chrono::milliseconds sample_period)
+        : sample_period_(sample_period)
+    {
+    }
+
+    FuelLevelPublisher::Subscription FuelLevelPublisher::subscribe(const SubscriptionOptions &options,
+                                                                   std::function<void()> on_evict)
+    {
+        auto queue = std::make_shared<Queue>(options.policy, options.queue_depth, options.max_lag);
+
+        auto now = std::chrono::steady_clock::now();
+        std::vector<std::chrono::steady_clock::time_point> next_due;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Hand new subscribers the cached sample so they do not wait a full period
+        if (latest_.timestamp_ms != 0) {
+            queue->push(latest_, now);
+            next_due.resize(latest_.zone + 1, now);
+            next_due[latest_.zone] = now + options.interval;
+        }
+
+        std::shared_ptr<EvictHook> hook;
+        if (on_evict) {
+            hook = std::make_shared<EvictHook>();
+            hook->callback = std::move(on_evict);
+        }
+
+        uint64_t id = next_id_++;
+        subscribers_.push_back({id, options, queue, std::move(hook), std::move(next_due), false});
+        LOG_DEBUG("Subscriber {} registered ({} active)", id, subscribers_.size());
+        return {id, queue};
+    }
+
+    void FuelLevelPublisher::unsubscribe(uint64_t id)
+    {
+        std::shared_ptr<EvictHook> hook;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = std::find_if(subscribers_.begin(), subscribers_.end(),
+                                   [id](const Subscriber &subscriber) { return subscriber.id == id; });
+            if (it == subscribers_.end()) return;
+
+            it->queue->close();
+            hook = std::move(it->on_evict);
+            subscribers_.erase(it);
+            LOG_DEBUG("Subscriber {} removed ({} active)", id, subscribers_.size());
+        }
+
+        // publish() may have picked up the hook already; wait out a running
+        // callback and make sure a pending one finds nothing to call
+        if (hook) {
+            std::lock_guard<std::mutex> lock(hook->mutex);
+            hook->callback = nullptr;
+        }
+    }
+
+    void FuelLevelPublisher::publish(const FuelSample &sample)
+    {
+        auto now = std::chrono::steady_clock::now();
+        // A subscriber is due if its next slot falls within half a sample period,
+        // so an interval equal to the sample period does not slip a whole tick on jitter
+        auto horizon = now + sample_period_ / 2;
+        std::vector<std::shared_ptr<EvictHook>> evicted;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            latest_ = sample;
+
+            for (auto &subscriber : subscribers_) {
+                if (sample.zone >= subscriber.next_due.size()) {
+                    subscriber.next_due.resize(sample.zone + 1, now);
+                }
+
+                auto &next_due = subscriber.next_due[sample.zone];
+                if (next_due > horizon) continue;
+
+                next_due += subscriber.options.interval;
+                if (next_due <= now) {
+                    next_due = now + subscriber.options.interval;
+                }
+
+                if (subscriber.queue->push(sample, now) || subscriber.evicted) continue;
+
+                subscriber.evicted = true;
+                LOG_WARNING("Subscriber {} exceeded its lag limit and was disconnected", subscriber.id);
+                if (subscriber.on_evict) {
+                    evicted.push_back(subscriber.on_evict);
+                }
+            }
+        }
+
+        for (auto &hook : evicted) {
+            std::lock_guard<std::mutex> lock(hook->mutex);
+            if (hook->callback) {
+                hook->callback();
+            }
+        }
+    }
+
+    FuelSample FuelLevelPublisher::latest() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return latest_;
+    }
+
+    std::vector<SubscriberStats> FuelLevelPublisher::stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<SubscriberStats> result;
+        result.reserve(subscribers_.size());
+        for (const auto &subscriber : subscribers_) {
+            result.push_back({subscriber.id, subscriber.options.policy, subscriber.queue->stats()});
+        }
+        return result;
+    }
+
+} // namespace Streaming
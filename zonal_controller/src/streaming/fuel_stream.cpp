@@ -0,0 +1,178 @@
+#include "../include/streaming/fuel_stream.h"
+#include <algorithm>
+#include <mutex>
+#include <google/protobuf/arena.h>
+#include "../include/config.hpp"
+#include "../include/logger.hpp"
+#include "../include/tracing/trace_context.h"
+
+namespace Streaming
+{
+    namespace
+    {
+        // How long a stream handler waits for a sample before re-checking cancellation
+        constexpr std::chrono::milliseconds kStreamPollInterval(200);
+
+        // Arena block for the reused stream message; comfortably fits a FuelLevelResponse
+        constexpr std::size_t kStreamArenaBlockSize = 512;
+    }
+
+    SubscriptionOptions MakeSubscriptionOptions(const obd::FuelLevelStreamRequest &request)
+    {
+        auto &config = zonal_controller::Config::getInstance();
+        SubscriptionOptions options;
+
+        // Get the requested interval (default to 1 second if 0)
+        uint32_t interval_seconds = request.interval_seconds();
+        if (interval_seconds == 0)
+        {
+            interval_seconds = 1;
+            LOG_WARNING("Stream interval was 0, defaulting to 1 second");
+        }
+        options.interval = std::chrono::seconds(interval_seconds);
+
+        switch (request.backpressure_policy())
+        {
+        case obd::BACKPRESSURE_DROP_OLDEST:
+            options.policy = OverflowPolicy::DROP_OLDEST;
+            break;
+        case obd::BACKPRESSURE_DISCONNECT:
+            options.policy = OverflowPolicy::DISCONNECT;
+            break;
+        default:
+            options.policy = OverflowPolicy::CONFLATE;
+            break;
+        }
+
+        // Clamp the queue so a single subscriber cannot claim unbounded memory
+        uint32_t queue_depth = request.queue_depth();
+        if (queue_depth == 0)
+        {
+            queue_depth = static_cast<uint32_t>(std::max(1, config.getStreamQueueDepth()));
+        }
+        options.queue_depth = std::min<std::size_t>(queue_depth, std::max(1, config.getStreamMaxQueueDepth()));
+
+        uint32_t max_lag_ms = request.max_lag_ms();
+        if (max_lag_ms == 0 && options.policy == OverflowPolicy::DISCONNECT)
+        {
+            max_lag_ms = static_cast<uint32_t>(std::max(0, config.getStreamMaxLagMs()));
+        }
+        options.max_lag = std::chrono::milliseconds(max_lag_ms);
+
+        return options;
+    }
+
+    void FillFuelLevelResponse(const FuelSample &sample, const std::vector<std::string> &zone_names,
+                               obd::FuelLevelResponse *response)
+    {
+        // Set the fuel level
+        response->set_level_percent(sample.level_percent);
+
+        // Set the timestamp of the reading in milliseconds
+        response->set_timestamp_ms(sample.timestamp_ms);
+
+        // Set status to OK
+        response->set_status(0);
+
+        if (sample.zone < zone_names.size())
+        {
+            response->set_source_zone(zone_names[sample.zone]);
+        }
+        else
+        {
+            response->clear_source_zone();
+        }
+    }
+
+    grpc::Status ServeFuelStream(FuelLevelPublisher &publisher, grpc::ServerContext *context,
+                                 const obd::FuelLevelStreamRequest &request,
+                                 grpc::ServerWriter<obd::FuelLevelResponse> *writer,
+                                 const std::vector<std::string> &zone_names)
+    {
+        Tracing::ScopedTrace trace(*context);
+        LOG_INFO("Starting fuel level stream with interval: {} seconds", request.interval_seconds());
+        SubscriptionOptions options = MakeSubscriptionOptions(request);
+
+        // An evicted handler that is waiting on its queue wakes up by itself and
+        // ends the call with RESOURCE_EXHAUSTED. Only a handler blocked in Write()
+        // on a client that stopped reading needs the call cancelled to get out.
+        // unsubscribe() waits for a running callback, so the capture stays valid.
+        struct WriteState {
+            std::mutex mutex;
+            bool writing = false;
+            bool evicted = false;
+        } write_state;
+        auto subscription = publisher.subscribe(options, [context, &write_state]() {
+            std::lock_guard<std::mutex> lock(write_state.mutex);
+            write_state.evicted = true;
+            if (write_state.writing)
+            {
+                context->TryCancel();
+            }
+        });
+
+        // One message per stream, allocated on a stack-backed arena and
+        // overwritten for every sample, so steady-state writes never allocate
+        alignas(8) char arena_block[kStreamArenaBlockSize];
+        google::protobuf::Arena arena(arena_block, sizeof(arena_block));
+        auto *response = google::protobuf::Arena::CreateMessage<obd::FuelLevelResponse>(&arena);
+
+        // Stream fuel level updates until client disconnects
+        FuelSample sample;
+        while (!context->IsCancelled())
+        {
+            PopResult result = subscription.queue->pop(sample, kStreamPollInterval);
+            if (result == PopResult::TIMEOUT)
+            {
+                continue;
+            }
+            if (result == PopResult::CLOSED)
+            {
+                break;
+            }
+
+            LOG_DEBUG("Streaming fuel level: {}%", sample.level_percent);
+
+            TRACE_SPAN("FuelStream.sample");
+            {
+                TRACE_SPAN("FillFuelLevelResponse");
+                FillFuelLevelResponse(sample, zone_names, response);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(write_state.mutex);
+                if (write_state.evicted)
+                {
+                    break;
+                }
+                write_state.writing = true;
+            }
+
+            // Write the response to the stream; serialization happens inside Write()
+            TRACE_SPAN("FuelStream.serialize_write");
+            bool written = writer->Write(*response);
+            {
+                std::lock_guard<std::mutex> lock(write_state.mutex);
+                write_state.writing = false;
+            }
+            if (!written)
+            {
+                LOG_INFO("Client disconnected from fuel level stream");
+                break;
+            }
+        }
+
+        QueueStats stats = subscription.queue->stats();
+        publisher.unsubscribe(subscription.id);
+        LOG_INFO("Fuel level stream {} closed: delivered {}, dropped {}, max queue depth {}",
+                 subscription.id, stats.delivered, stats.dropped, stats.max_depth);
+
+        if (stats.evicted)
+        {
+            return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                                "Subscriber fell too far behind the fuel level stream");
+        }
+        return grpc::Status::OK;
+    }
+
+} // namespace Streaming
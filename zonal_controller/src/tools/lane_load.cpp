@@ -0,0 +1,231 @@
+/**
+ * @file lane_load.cpp
+ * @brief Saturates the telemetry RPCs while sampling control (lighting) latency
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <grpcpp/grpcpp.h>
+#include "lanes/execution_lane.h"
+#include "lanes/latency_histogram.h"
+#include "lighting_service.grpc.pb.h"
+#include "obd_service.grpc.pb.h"
+
+namespace {
+    struct Options {
+        std::string address = "localhost:50051";
+        int duration_s = 10;
+        int readers = 8;
+        int streams = 100;
+        int control_hz = 50;
+    };
+
+    void PrintUsage(const char* program)
+    {
+        std::cerr << "Usage: " << program << " [--address <host:port>] [--duration <s>] [--readers <n>]\n"
+                  << "       " << std::string(std::char_traits<char>::length(program), ' ')
+                  << " [--streams <n>] [--control-hz <n>]\n"
+                  << "\n"
+                  << "  Samples SetHeadlight latency for --duration seconds with no load, then again\n"
+                  << "  while --readers threads issue GetFuelLevel/QueryPids back to back and --streams\n"
+                  << "  fuel streams are open. Control calls carry their send time so the server's\n"
+                  << "  control lane histogram includes queueing as well.\n";
+    }
+
+    std::string SentAtNow()
+    {
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        return std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+    }
+
+    struct ControlResult {
+        Lanes::LatencyHistogram::Counts counts{};
+        std::chrono::microseconds max{0};
+        int failures = 0;
+    };
+
+    // Toggles the headlight at a fixed rate until the deadline, timing each call from the client
+    ControlResult SampleControl(lighting::LightingService::Stub& stub, const Options& options,
+                                std::chrono::steady_clock::time_point deadline)
+    {
+        Lanes::LatencyHistogram histogram;
+        ControlResult result;
+        auto period = std::chrono::microseconds(1000000 / std::max(1, options.control_hz));
+        auto next = std::chrono::steady_clock::now();
+        bool on = false;
+
+        while (next < deadline) {
+            std::this_thread::sleep_until(next);
+            next += period;
+
+            grpc::ClientContext context;
+            context.AddMetadata(Lanes::kSentAtMetadataKey, SentAtNow());
+            context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(5));
+            lighting::SetHeadlightRequest request;
+            request.set_turn_on(on = !on);
+            lighting::SetHeadlightResponse response;
+
+            auto sent = std::chrono::steady_clock::now();
+            grpc::Status status = stub.SetHeadlight(&context, request, &response);
+            auto latency = std::chrono::steady_clock::now() - sent;
+            if (!status.ok()) {
+                ++result.failures;
+                continue;
+            }
+            histogram.record(latency);
+            result.max = std::max(result.max, std::chrono::duration_cast<std::chrono::microseconds>(latency));
+        }
+        result.counts = histogram.counts();
+        return result;
+    }
+
+    // Issues telemetry reads back to back until stopped
+    void ReadLoop(obd::OBDService::Stub& stub, const std::atomic<bool>& running, std::atomic<uint64_t>& calls)
+    {
+        obd::QueryPidsRequest pids;
+        auto* query = pids.add_queries();
+        query->set_mode(0x01);
+        for (uint32_t pid : {0x01u, 0x1Fu, 0x2Fu}) {
+            query->add_pids(pid);
+        }
+        obd::FuelLevelRequest fuel;
+        bool use_pids = false;
+
+        while (running.load(std::memory_order_relaxed)) {
+            grpc::ClientContext context;
+            context.AddMetadata(Lanes::kSentAtMetadataKey, SentAtNow());
+            grpc::Status status;
+            if (use_pids) {
+                obd::QueryPidsResponse response;
+                status = stub.QueryPids(&context, pids, &response);
+            } else {
+                obd::FuelLevelResponse response;
+                status = stub.GetFuelLevel(&context, fuel, &response);
+            }
+            use_pids = !use_pids;
+            if (status.ok()) calls.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Holds one fuel stream open and drains it until cancelled
+    void StreamLoop(obd::OBDService::Stub& stub, grpc::ClientContext& context, std::atomic<uint64_t>& messages)
+    {
+        obd::FuelLevelStreamRequest request;
+        request.set_interval_seconds(1);
+        auto reader = stub.StreamFuelLevel(&context, request);
+        obd::FuelLevelResponse response;
+        while (reader->Read(&response)) {
+            messages.fetch_add(1, std::memory_order_relaxed);
+        }
+        reader->Finish();
+    }
+
+    void Report(const char* phase, const ControlResult& result)
+    {
+        uint64_t calls = Lanes::LatencyHistogram::total(result.counts);
+        std::printf("%-9s control: %6llu calls  p50 <= %6lld us  p99 <= %6lld us  max %6lld us  %d failed\n", phase,
+                    static_cast<unsigned long long>(calls),
+                    static_cast<long long>(Lanes::LatencyHistogram::percentile(result.counts, 50.0).count()),
+                    static_cast<long long>(Lanes::LatencyHistogram::percentile(result.counts, 99.0).count()),
+                    static_cast<long long>(result.max.count()), result.failures);
+    }
+
+    bool ParseArgs(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) return false;
+            if (arg == "--address") {
+                options.address = argv[++i];
+            } else if (arg == "--duration") {
+                options.duration_s = std::atoi(argv[++i]);
+            } else if (arg == "--readers") {
+                options.readers = std::atoi(argv[++i]);
+            } else if (arg == "--streams") {
+                options.streams = std::atoi(argv[++i]);
+            } else if (arg == "--control-hz") {
+                options.control_hz = std::atoi(argv[++i]);
+            } else {
+                return false;
+            }
+        }
+        return options.duration_s > 0 && options.readers >= 0 && options.streams >= 0 && options.control_hz > 0;
+    }
+}
+
+/**
+ * @brief Main entry point
+ *
+ * Runs an idle phase and a loaded phase of the same length and prints the
+ * control latency of each next to the telemetry throughput achieved, so
+ * the two p99 values can be compared directly.
+ *
+ * @param argc Number of command line arguments
+ * @param argv Command line arguments
+ * @return int 0 on success, 1 if any control call failed, 2 on bad usage
+ */
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!ParseArgs(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    // Control and telemetry use separate channels, as separate clients would
+    auto control_channel = grpc::CreateChannel(options.address, grpc::InsecureChannelCredentials());
+    auto lighting = lighting::LightingService::NewStub(control_channel);
+    grpc::ChannelArguments args;
+    args.SetInt("lane_load_telemetry", 1);  // Distinct arguments keep the channels from sharing a connection
+    auto telemetry_channel =
+        grpc::CreateCustomChannel(options.address, grpc::InsecureChannelCredentials(), args);
+    auto obd = obd::OBDService::NewStub(telemetry_channel);
+
+    auto duration = std::chrono::seconds(options.duration_s);
+    ControlResult idle = SampleControl(*lighting, options, std::chrono::steady_clock::now() + duration);
+    Report("idle", idle);
+
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> stream_messages{0};
+    std::vector<std::unique_ptr<grpc::ClientContext>> stream_contexts;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.streams; ++i) {
+        stream_contexts.push_back(std::make_unique<grpc::ClientContext>());
+        threads.emplace_back(StreamLoop, std::ref(*obd), std::ref(*stream_contexts.back()),
+                             std::ref(stream_messages));
+    }
+    for (int i = 0; i < options.readers; ++i) {
+        threads.emplace_back(ReadLoop, std::ref(*obd), std::cref(running), std::ref(reads));
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    ControlResult loaded = SampleControl(*lighting, options, started + duration);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    uint64_t read_count = reads.load();
+    uint64_t message_count = stream_messages.load();
+
+    running = false;
+    for (auto& context : stream_contexts) {
+        context->TryCancel();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Report("loaded", loaded);
+    std::printf("telemetry: %.0f reads/s from %d readers, %.0f stream messages/s over %d streams\n",
+                read_count / seconds, options.readers, message_count / seconds, options.streams);
+    return idle.failures + loaded.failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file obd_probe.cpp
+ * @brief OBD-II tester: sends Mode 01/09 requests over ISO-TP and times the responses
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "obd2/iso_tp_client.h"
+#include "obd2/pid_table.h"
+
+namespace {
+    struct Options {
+        std::string interface = "vcan0";
+        bool physical = false;
+        Obd2::IsoTpClientOptions client;
+        int count = 1;
+        int timeout_ms = 1000;
+        std::vector<uint8_t> request = {Obd2::kModeCurrentData, 0x00};
+    };
+
+    void PrintUsage(const char* program)
+    {
+        std::cerr << "Usage: " << program << " [--interface <if>] [--physical] [--count <n>] [--timeout <ms>]\n"
+                  << "       " << std::string(std::char_traits<char>::length(program), ' ')
+                  << " [--block-size <n>] [--st-min <us>] [<mode> <pid>...]\n"
+                  << "\n"
+                  << "  Mode and PIDs are hex (default: 01 00). Requests go to 0x7DF, or 0x7E0 with\n"
+                  << "  --physical; responses are read from 0x7E8. --count > 1 reports throughput.\n";
+    }
+
+    bool ParseHexByte(const char* text, uint8_t& value)
+    {
+        char* end = nullptr;
+        long parsed = std::strtol(text, &end, 16);
+        if (end == text || *end != '\0' || parsed < 0 || parsed > 0xFF) return false;
+        value = static_cast<uint8_t>(parsed);
+        return true;
+    }
+
+    void PrintResponse(const std::vector<uint8_t>& response)
+    {
+        for (uint8_t byte : response) std::printf("%02X ", byte);
+        std::printf("\n");
+        if (response.size() >= 3 && response[0] == Obd2::kNegativeResponse) {
+            std::printf("  negative response to mode %02X: code %02X\n", response[1], response[2]);
+            return;
+        }
+        if (response.empty() || response[0] < Obd2::kPositiveResponseOffset) return;
+
+        // Walk PID + data pairs; lengths come from the controller's own table
+        uint8_t mode = static_cast<uint8_t>(response[0] - Obd2::kPositiveResponseOffset);
+        std::size_t offset = 1;
+        while (offset < response.size()) {
+            uint8_t pid = response[offset++];
+            const Obd2::PidHandler* handler = Obd2::FindPid(mode, pid);
+            std::size_t length = handler != nullptr ? handler->length : ((pid & 0x1F) == 0 ? 4 : 0);
+            if (length == 0 || offset + length > response.size()) {
+                std::printf("  %02X: unknown PID, stopping\n", pid);
+                return;
+            }
+            const uint8_t* data = response.data() + offset;
+            if (handler == nullptr) {
+                std::printf("  %02X pids_supported: %02X%02X%02X%02X\n", pid, data[0], data[1], data[2], data[3]);
+            } else if (handler->text) {
+                std::string text(reinterpret_cast<const char*>(data + 1), length - 1);
+                text.erase(std::find(text.begin(), text.end(), '\0'), text.end());
+                std::printf("  %02X %s: %s\n", pid, handler->name, text.c_str());
+            } else {
+                std::printf("  %02X %s: %g %s\n", pid, handler->name, handler->decode(data), handler->unit);
+            }
+            offset += length;
+        }
+    }
+
+    int RunOnce(const Options& options, Obd2::IsoTpClient& client)
+    {
+        std::vector<uint8_t> response;
+        std::string error;
+        if (!client.request(options.request.data(), options.request.size(), response,
+                            std::chrono::milliseconds(options.timeout_ms), &error)) {
+            std::cerr << "No response: " << error << std::endl;
+            return 1;
+        }
+        PrintResponse(response);
+        return 0;
+    }
+
+    int RunThroughput(const Options& options, Obd2::IsoTpClient& client)
+    {
+        std::vector<double> latencies_us;
+        latencies_us.reserve(static_cast<std::size_t>(options.count));
+        std::vector<uint8_t> response;
+        std::size_t bytes = 0;
+        int failures = 0;
+        std::string error;
+
+        auto started = std::chrono::steady_clock::now();
+        for (int i = 0; i < options.count; ++i) {
+            auto sent = std::chrono::steady_clock::now();
+            if (!client.request(options.request.data(), options.request.size(), response,
+                                std::chrono::milliseconds(options.timeout_ms), &error)) {
+                if (++failures == 1) std::cerr << "First failure: " << error << std::endl;
+                continue;
+            }
+            latencies_us.push_back(
+                std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sent).count());
+            bytes += response.size();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        std::sort(latencies_us.begin(), latencies_us.end());
+        auto percentile = [&](double p) {
+            if (latencies_us.empty()) return 0.0;
+            return latencies_us[std::min(latencies_us.size() - 1, static_cast<std::size_t>(p * latencies_us.size()))];
+        };
+        std::printf("%d requests in %.3f s: %.0f requests/s, %.0f payload bytes/s, %d failed\n", options.count,
+                    seconds, latencies_us.size() / seconds, bytes / seconds, failures);
+        std::printf("latency us: p50 %.0f  p99 %.0f  max %.0f\n", percentile(0.50), percentile(0.99),
+                    latencies_us.empty() ? 0.0 : latencies_us.back());
+        return failures == 0 ? 0 : 1;
+    }
+}
+
+/**
+ * @brief Main entry point
+ *
+ * Sends one request and prints the decoded response, or with --count
+ * sends requests back to back and reports throughput and latency.
+ *
+ * @param argc Number of command line arguments
+ * @param argv Command line arguments
+ * @return int Exit code (0 on success)
+ */
+int main(int argc, char** argv)
+{
+    Options options;
+    std::vector<uint8_t> request;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--interface" && has_value) {
+            options.interface = argv[++i];
+        } else if (arg == "--physical") {
+            options.physical = true;
+        } else if (arg == "--count" && has_value) {
+            options.count = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--timeout" && has_value) {
+            options.timeout_ms = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--block-size" && has_value) {
+            options.client.block_size = static_cast<uint8_t>(std::clamp(std::atoi(argv[++i]), 0, 0xFF));
+        } else if (arg == "--st-min" && has_value) {
+            options.client.st_min = Obd2::EncodeSeparationTime(std::chrono::microseconds(std::atoi(argv[++i])));
+        } else {
+            uint8_t byte;
+            if (!ParseHexByte(argv[i], byte)) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            request.push_back(byte);
+        }
+    }
+    if (!request.empty()) {
+        if (request.size() < 2 || request.size() > 1 + Obd2::kMaxPidsPerRequest) {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+        options.request = request;
+    }
+    if (options.physical) {
+        options.client.request_id = options.client.flow_control_id;
+    }
+
+    int socket;
+    try {
+        socket = Obd2::OpenCanSocket(options.interface, {options.client.response_id});
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    Obd2::IsoTpClient client(socket, options.client);
+    int result = options.count > 1 ? RunThroughput(options, client) : RunOnce(options, client);
+    close(socket);
+    return result;
+}
@@ -0,0 +1,232 @@
+/**
+ * @file zc_top.cpp
+ * @brief top-style view of a running controller's resource usage
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <grpcpp/grpcpp.h>
+#include "diagnostics_service.grpc.pb.h"
+
+namespace {
+    struct Options {
+        std::string address = "localhost:50051";
+        int interval_s = 2;
+        bool once = false;
+        std::size_t max_threads = 20;
+        int profile_s = 0;
+        int frequency_hz = 0;
+        int top = 25;
+        bool folded = false;
+    };
+
+    void PrintUsage(const char* program)
+    {
+        std::cerr << "Usage: " << program << " [--address <host:port>] [--interval <s>] [--once] [--threads <n>]\n"
+                  << "       " << program << " --profile <s> [--frequency <hz>] [--top <n>] [--folded]\n"
+                  << "\n"
+                  << "  --profile  capture a CPU profile of the server instead of showing usage;\n"
+                  << "             --folded prints the stacks in folded form for flamegraph.pl\n";
+    }
+
+    std::string FormatBytes(double bytes)
+    {
+        static const char* kUnits[] = {"B", "KiB", "MiB", "GiB"};
+        int unit = 0;
+        while (bytes >= 1024.0 && unit < 3) {
+            bytes /= 1024.0;
+            ++unit;
+        }
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), unit == 0 ? "%.0f %s" : "%.1f %s", bytes, kUnits[unit]);
+        return buf;
+    }
+
+    void PrintSample(const Options& options, const diagnostics::GetSamplesResponse& response)
+    {
+        const auto& sample = response.samples(response.samples_size() - 1);
+
+        // Allocation rates need the previous sample
+        double alloc_rate = 0.0, alloc_bytes_rate = 0.0;
+        if (response.samples_size() >= 2) {
+            const auto& previous = response.samples(response.samples_size() - 2);
+            double seconds = (sample.timestamp_ms() - previous.timestamp_ms()) / 1000.0;
+            if (seconds > 0) {
+                alloc_rate = (sample.allocations() - previous.allocations()) / seconds;
+                alloc_bytes_rate = (sample.allocated_bytes() - previous.allocated_bytes()) / seconds;
+            }
+        }
+
+        if (!options.once) {
+            std::cout << "\033[H\033[2J";
+        }
+        std::time_t time = static_cast<std::time_t>(sample.timestamp_ms() / 1000);
+        char when[32];
+        std::strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", std::localtime(&time));
+
+        std::printf("zonal_controller @ %s  %s\n\n", options.address.c_str(), when);
+        std::printf("CPU %6.1f%%   RSS %s   VM %s   heap in use %s\n", sample.cpu_percent(),
+                    FormatBytes(sample.rss_bytes()).c_str(), FormatBytes(sample.vm_bytes()).c_str(),
+                    FormatBytes(sample.heap_in_use_bytes()).c_str());
+        std::printf("Allocs %.0f/s (%s/s)   live %lld allocations, %s\n", alloc_rate,
+                    FormatBytes(alloc_bytes_rate).c_str(),
+                    static_cast<long long>(sample.allocations() - sample.frees()),
+                    FormatBytes(static_cast<double>(sample.allocated_bytes() - sample.freed_bytes())).c_str());
+        std::printf("Streams: fuel subscribers %u   rule watchers %u   http %u   logger backlog %u\n\n",
+                    sample.fuel_subscribers(), sample.rule_watchers(), sample.http_streams(),
+                    sample.logger_backlog());
+
+        if (sample.queues_size() > 0) {
+            std::printf("%-24s %7s %7s %10s\n", "QUEUE", "DEPTH", "CAP", "DROPPED");
+            for (const auto& queue : sample.queues()) {
+                std::printf("%-24s %7u %7u %10llu\n", queue.name().c_str(), queue.depth(), queue.capacity(),
+                            static_cast<unsigned long long>(queue.dropped()));
+            }
+            std::printf("\n");
+        }
+
+        std::vector<const diagnostics::ThreadUsage*> threads;
+        for (const auto& thread : sample.threads()) {
+            threads.push_back(&thread);
+        }
+        std::sort(threads.begin(), threads.end(), [](const auto* a, const auto* b) {
+            return a->cpu_percent() != b->cpu_percent() ? a->cpu_percent() > b->cpu_percent()
+                                                        : a->cpu_time_ms() > b->cpu_time_ms();
+        });
+        std::printf("%7s  %-16s %7s %12s\n", "TID", "THREAD", "CPU%", "TIME(ms)");
+        for (std::size_t i = 0; i < threads.size() && i < options.max_threads; ++i) {
+            std::printf("%7u  %-16s %7.1f %12llu\n", threads[i]->tid(), threads[i]->name().c_str(),
+                        threads[i]->cpu_percent(), static_cast<unsigned long long>(threads[i]->cpu_time_ms()));
+        }
+        if (threads.size() > options.max_threads) {
+            std::printf("  ... %zu more threads\n", threads.size() - options.max_threads);
+        }
+        std::fflush(stdout);
+    }
+
+    int RunTop(const Options& options, diagnostics::Diagnostics::Stub& stub)
+    {
+        for (;;) {
+            grpc::ClientContext context;
+            context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(5));
+            diagnostics::GetSamplesRequest request;
+            request.set_max_samples(2);
+            diagnostics::GetSamplesResponse response;
+            grpc::Status status = stub.GetSamples(&context, request, &response);
+            if (!status.ok()) {
+                std::cerr << "GetSamples failed: " << status.error_message() << std::endl;
+                return 1;
+            }
+
+            if (response.samples_size() == 0) {
+                std::cout << "Waiting for the first sample..." << std::endl;
+            } else {
+                PrintSample(options, response);
+            }
+            if (options.once) {
+                return 0;
+            }
+            std::this_thread::sleep_for(std::chrono::seconds(options.interval_s));
+        }
+    }
+
+    int RunProfile(const Options& options, diagnostics::Diagnostics::Stub& stub)
+    {
+        grpc::ClientContext context;
+        context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(options.profile_s + 30));
+        diagnostics::CaptureProfileRequest request;
+        request.set_duration_s(static_cast<uint32_t>(options.profile_s));
+        request.set_frequency_hz(static_cast<uint32_t>(options.frequency_hz));
+        request.set_max_entries(static_cast<uint32_t>(options.top));
+        diagnostics::CaptureProfileResponse response;
+
+        std::cerr << "Profiling " << options.address << " for " << options.profile_s << " s..." << std::endl;
+        grpc::Status status = stub.CaptureProfile(&context, request, &response);
+        if (!status.ok()) {
+            std::cerr << "CaptureProfile failed: " << status.error_message() << std::endl;
+            return 1;
+        }
+
+        if (options.folded) {
+            for (const auto& stack : response.stacks()) {
+                std::printf("%s %llu\n", stack.name().c_str(), static_cast<unsigned long long>(stack.samples()));
+            }
+            return 0;
+        }
+
+        double total = std::max<double>(1.0, static_cast<double>(response.samples()));
+        std::printf("%llu samples, %llu lost\n\n", static_cast<unsigned long long>(response.samples()),
+                    static_cast<unsigned long long>(response.lost()));
+        std::printf("%8s %6s  %s\n", "SAMPLES", "%", "FUNCTION");
+        for (const auto& entry : response.functions()) {
+            std::printf("%8llu %6.1f  %s\n", static_cast<unsigned long long>(entry.samples()),
+                        100.0 * entry.samples() / total, entry.name().c_str());
+        }
+        std::printf("\n%8s %6s  %s\n", "SAMPLES", "%", "THREAD");
+        for (const auto& entry : response.threads()) {
+            std::printf("%8llu %6.1f  %s\n", static_cast<unsigned long long>(entry.samples()),
+                        100.0 * entry.samples() / total, entry.name().c_str());
+        }
+        return 0;
+    }
+}
+
+/**
+ * @brief Main entry point
+ *
+ * Shows the controller's resource usage, refreshed every interval, or
+ * captures a CPU profile with --profile.
+ *
+ * @param argc Number of command line arguments
+ * @param argv Command line arguments
+ * @return int Exit code (0 on success)
+ */
+int main(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--address" && has_value) {
+            options.address = argv[++i];
+        } else if (arg == "--interval" && has_value) {
+            options.interval_s = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--once") {
+            options.once = true;
+        } else if (arg == "--threads" && has_value) {
+            options.max_threads = static_cast<std::size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--profile" && has_value) {
+            options.profile_s = std::atoi(argv[++i]);
+            if (options.profile_s <= 0) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--frequency" && has_value) {
+            options.frequency_hz = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--top" && has_value) {
+            options.top = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--folded") {
+            options.folded = true;
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    auto channel = grpc::CreateChannel(options.address, grpc::InsecureChannelCredentials());
+    auto stub = diagnostics::Diagnostics::NewStub(channel);
+    if (options.profile_s > 0) {
+        return RunProfile(options, *stub);
+    }
+    return RunTop(options, *stub);
+}
@@ -0,0 +1,134 @@
+#include "../include/tracing/span.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Tracing
+{
+    namespace
+    {
+        // Single-producer ring: the owning thread advances head, the exporter advances tail
+        struct ThreadBuffer
+        {
+            explicit ThreadBuffer(std::size_t capacity) : spans(new SpanRecord[capacity]), mask(capacity - 1) {}
+
+            std::unique_ptr<SpanRecord[]> spans;
+            const std::size_t mask;
+            uint32_t tid = 0;  // Owning thread; set under the registry mutex when a thread takes the buffer
+            alignas(64) std::atomic<uint64_t> head{0};
+            alignas(64) std::atomic<uint64_t> tail{0};
+            std::atomic<uint64_t> dropped{0};
+        };
+
+        std::atomic<std::size_t> g_capacity{8192};
+
+        // Buffers are never freed, so the exporter can still drain the spans
+        // of a thread that has exited. The thread's buffer goes on the free
+        // list instead and is handed to the next thread that records a span,
+        // so thread churn does not grow the registry.
+        std::mutex g_registry_mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> g_registry;
+        std::vector<ThreadBuffer *> g_free;
+
+        // Kept trivial so Record() reads it without a TLS init guard
+        thread_local ThreadBuffer *t_buffer = nullptr;
+
+        // Returns the thread's buffer to the free list when the thread exits
+        struct ThreadRelease
+        {
+            bool armed = false;
+
+            ~ThreadRelease()
+            {
+                if (!armed || !t_buffer) return;
+                std::lock_guard<std::mutex> lock(g_registry_mutex);
+                g_free.push_back(t_buffer);
+                t_buffer = nullptr;
+            }
+        };
+        thread_local ThreadRelease t_release;
+
+        ThreadBuffer *RegisterThread()
+        {
+            std::size_t capacity = g_capacity.load(std::memory_order_relaxed);
+            auto tid = static_cast<uint32_t>(syscall(SYS_gettid));
+            {
+                std::lock_guard<std::mutex> lock(g_registry_mutex);
+                // Spans the last owner left behind keep their tid and are drained as usual
+                auto it = std::find_if(g_free.begin(), g_free.end(),
+                                       [capacity](ThreadBuffer *buffer) { return buffer->mask + 1 == capacity; });
+                if (it != g_free.end())
+                {
+                    t_buffer = *it;
+                    g_free.erase(it);
+                }
+                else
+                {
+                    g_registry.push_back(std::make_unique<ThreadBuffer>(capacity));
+                    t_buffer = g_registry.back().get();
+                }
+                t_buffer->tid = tid;
+            }
+            // The first use of the release object registers its destructor for this thread
+            t_release.armed = true;
+            return t_buffer;
+        }
+    }
+
+    void Record(const char *name, uint64_t trace_id, uint64_t start, uint64_t end)
+    {
+        ThreadBuffer *buffer = t_buffer ? t_buffer : RegisterThread();
+
+        uint64_t head = buffer->head.load(std::memory_order_relaxed);
+        if (head - buffer->tail.load(std::memory_order_acquire) > buffer->mask)
+        {
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        SpanRecord &span = buffer->spans[head & buffer->mask];
+        span.name = name;
+        span.trace_id = trace_id;
+        span.start = start;
+        span.end = end;
+        span.tid = buffer->tid;
+        buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    void SetBufferCapacity(std::size_t spans)
+    {
+        std::size_t capacity = 1;
+        while (capacity < spans)
+        {
+            capacity <<= 1;
+        }
+        g_capacity.store(capacity, std::memory_order_relaxed);
+    }
+
+    uint64_t Drain(std::vector<SpanRecord> &out)
+    {
+        uint64_t dropped = 0;
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        for (auto &buffer : g_registry)
+        {
+            uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+            uint64_t head = buffer->head.load(std::memory_order_acquire);
+            for (; tail != head; ++tail)
+            {
+                out.push_back(buffer->spans[tail & buffer->mask]);
+            }
+            buffer->tail.store(tail, std::memory_order_release);
+            dropped += buffer->dropped.exchange(0, std::memory_order_relaxed);
+        }
+        return dropped;
+    }
+
+    std::size_t BufferCount()
+    {
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        return g_registry.size();
+    }
+
+} // namespace Tracing
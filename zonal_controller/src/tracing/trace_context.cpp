@@ -0,0 +1,66 @@
+#include "../include/tracing/trace_context.h"
+#include <atomic>
+#include <chrono>
+#include <string_view>
+
+namespace Tracing
+{
+    namespace
+    {
+        // Parses up to the last 16 hex digits of text; returns 0 if any character is not hex
+        uint64_t ParseHex(std::string_view text)
+        {
+            if (text.size() > 16) text.remove_prefix(text.size() - 16);
+            uint64_t value = 0;
+            for (char c : text)
+            {
+                uint64_t digit;
+                if (c >= '0' && c <= '9') digit = c - '0';
+                else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+                else return 0;
+                value = (value << 4) | digit;
+            }
+            return value;
+        }
+
+        uint64_t NextTraceId()
+        {
+            // splitmix64 over a counter seeded at startup: unique per process, spread across runs
+            static std::atomic<uint64_t> counter{
+                static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count())};
+            uint64_t z = counter.fetch_add(0x9e3779b97f4a7c15ULL, std::memory_order_relaxed);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            z ^= z >> 31;
+            return z != 0 ? z : 1;
+        }
+    }
+
+    uint64_t TraceIdFromMetadata(const grpc::ServerContextBase &context)
+    {
+        const auto &metadata = context.client_metadata();
+
+        auto it = metadata.find(kTraceIdKey);
+        if (it != metadata.end())
+        {
+            uint64_t id = ParseHex(std::string_view(it->second.data(), it->second.size()));
+            if (id != 0) return id;
+        }
+
+        // traceparent: version-traceid(32 hex)-parentid(16 hex)-flags
+        it = metadata.find("traceparent");
+        if (it != metadata.end())
+        {
+            std::string_view traceparent(it->second.data(), it->second.size());
+            if (traceparent.size() >= 35 && traceparent[2] == '-')
+            {
+                uint64_t id = ParseHex(traceparent.substr(3, 32));
+                if (id != 0) return id;
+            }
+        }
+
+        return NextTraceId();
+    }
+
+} // namespace Tracing
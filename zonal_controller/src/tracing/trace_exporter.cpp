@@ -0,0 +1,168 @@
+#include "../include/tracing/trace_exporter.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <unistd.h>
+#include "../include/http/json_writer.h"
+#include "../include/logger.hpp"
+
+namespace Tracing
+{
+    namespace
+    {
+        // Rate used until the exporter has run long enough to measure it precisely
+        constexpr std::chrono::milliseconds kCalibrationTime(10);
+        constexpr std::chrono::seconds kPreciseBaseline(1);
+
+        // A comm name is at most 15 bytes, so even fully escaped it fits
+        constexpr std::size_t kThreadArgsSize = 128;
+
+        std::string ThreadName(uint32_t tid)
+        {
+            std::ifstream comm("/proc/self/task/" + std::to_string(tid) + "/comm");
+            std::string name;
+            if (!std::getline(comm, name) || name.empty())
+            {
+                name = "thread-" + std::to_string(tid);
+            }
+            return name;
+        }
+    }
+
+    TraceExporter::TraceExporter(ExporterOptions options)
+        : options_(std::move(options)),
+          origin_ticks_(Now()),
+          origin_time_(std::chrono::steady_clock::now()),
+          pid_(static_cast<int>(getpid()))
+    {
+        std::this_thread::sleep_for(kCalibrationTime);
+        auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - origin_time_);
+        calibrated_rate_ = static_cast<double>(Now() - origin_ticks_) / elapsed.count();
+
+        std::error_code error;
+        std::filesystem::create_directories(options_.output_dir, error);
+        if (error)
+        {
+            LOG_ERROR("Cannot create trace directory {}: {}", options_.output_dir, error.message());
+        }
+
+        last_enabled_ = Enabled();
+        thread_ = std::thread(&TraceExporter::Run, this);
+        LOG_INFO("Trace exporter writing to {} every {} ms ({} ticks/us)", options_.output_dir,
+                 static_cast<long>(options_.interval.count()), static_cast<long>(calibrated_rate_));
+    }
+
+    TraceExporter::~TraceExporter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    void TraceExporter::Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        bool stopping = false;
+        while (!stopping)
+        {
+            stopping = cv_.wait_for(lock, options_.interval, [this] { return !running_; });
+
+            bool enabled = Enabled();
+            if (enabled != last_enabled_)
+            {
+                LOG_INFO("Tracing {}", enabled ? "enabled" : "disabled");
+                last_enabled_ = enabled;
+            }
+
+            // Spans recorded before tracing was switched off are still exported
+            lock.unlock();
+            Export();
+            lock.lock();
+        }
+    }
+
+    void TraceExporter::Export()
+    {
+        spans_.clear();
+        uint64_t dropped = Drain(spans_);
+        if (dropped > 0)
+        {
+            LOG_WARNING("Trace buffers full, {} spans dropped", dropped);
+        }
+        if (spans_.empty()) return;
+
+        std::string path = options_.output_dir + "/zc_trace_" + std::to_string(pid_) + "_" +
+                           std::to_string(sequence_++) + ".json";
+        if (!WriteFile(path))
+        {
+            LOG_ERROR("Failed to write trace file {}", path);
+            return;
+        }
+        LOG_DEBUG("Wrote {} spans to {}", spans_.size(), path);
+
+        files_.push_back(path);
+        while (options_.max_files > 0 && files_.size() > options_.max_files)
+        {
+            std::error_code error;
+            std::filesystem::remove(files_.front(), error);
+            files_.pop_front();
+        }
+    }
+
+    bool TraceExporter::WriteFile(const std::string &path) const
+    {
+        FILE *file = std::fopen(path.c_str(), "w");
+        if (!file) return false;
+
+        double rate = TicksPerMicrosecond();
+        std::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+        std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"zonal_controller\"}}",
+                     pid_);
+
+        std::set<uint32_t> tids;
+        for (const SpanRecord &span : spans_)
+        {
+            tids.insert(span.tid);
+        }
+        for (uint32_t tid : tids)
+        {
+            // Thread names are set by whoever created the thread and may hold quotes or control bytes
+            Http::JsonWriter<kThreadArgsSize> args;
+            args.begin_object();
+            args.field("name", ThreadName(tid));
+            args.end_object();
+            std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":%.*s}",
+                         pid_, tid, static_cast<int>(args.view().size()), args.view().data());
+        }
+
+        for (const SpanRecord &span : spans_)
+        {
+            double ts = static_cast<double>(static_cast<int64_t>(span.start - origin_ticks_)) / rate;
+            double dur = static_cast<double>(span.end - span.start) / rate;
+            std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u",
+                         span.name, ts, dur, pid_, span.tid);
+            if (span.trace_id != 0)
+            {
+                std::fprintf(file, ",\"args\":{\"trace_id\":\"%016llx\"}",
+                             static_cast<unsigned long long>(span.trace_id));
+            }
+            std::fputc('}', file);
+        }
+        std::fprintf(file, "\n]}\n");
+        return std::fclose(file) == 0;
+    }
+
+    double TraceExporter::TicksPerMicrosecond() const
+    {
+        auto elapsed = std::chrono::steady_clock::now() - origin_time_;
+        if (elapsed < kPreciseBaseline) return calibrated_rate_;
+
+        uint64_t ticks = Now() - origin_ticks_;
+        return static_cast<double>(ticks) / std::chrono::duration<double, std::micro>(elapsed).count();
+    }
+
+} // namespace Tracing
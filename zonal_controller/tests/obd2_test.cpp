@@ -0,0 +1,289 @@
+/**
+ * @file obd2_test.cpp
+ * @brief Unit tests for the OBD-II PID table and the ISO-TP server over a socketpair
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "obd2/iso_tp.h"
+#include "obd2/iso_tp_client.h"
+#include "obd2/obd2_server.h"
+#include "obd2/pid_table.h"
+#include "obd2/vehicle_state.h"
+#include "streaming/fuel_level_publisher.h"
+
+namespace {
+    using namespace std::chrono_literals;
+    using Bytes = std::vector<uint8_t>;
+
+    constexpr char kVin[] = "1M8GDM9AXKP042788";
+    constexpr char kEcuName[] = "ZONALCTRL";
+    constexpr uint32_t kRequestId = 0x7E0;
+    constexpr uint32_t kFunctionalId = 0x7DF;
+    constexpr uint32_t kResponseId = 0x7E8;
+
+    Obd2::VehicleState MakeState()
+    {
+        Obd2::VehicleState state;
+        state.fuel_level_percent = 50.0f;
+        state.run_time_s = 300;
+        state.vin = kVin;
+        state.ecu_name = kEcuName;
+        return state;
+    }
+
+    // Returns the response bytes, or an empty vector when there is nothing to send
+    Bytes Build(const Bytes& request, bool functional = false, Obd2::ResponseKind* kind = nullptr)
+    {
+        uint8_t out[Obd2::kMaxResponseSize];
+        std::size_t size = 0;
+        Obd2::ResponseKind result =
+            Obd2::BuildResponse(request.data(), request.size(), MakeState(), functional, out, size);
+        if (kind) *kind = result;
+        return Bytes(out, out + size);
+    }
+
+    Bytes TextResponse(uint8_t pid, const std::string& text, std::size_t length)
+    {
+        Bytes bytes(3 + length, 0);
+        bytes[0] = 0x49;
+        bytes[1] = pid;
+        bytes[2] = 0x01;
+        std::copy(text.begin(), text.end(), bytes.begin() + 3);
+        return bytes;
+    }
+}
+
+TEST(PidTable, AnswersSeveralPidsAndSkipsUnsupportedOnes)
+{
+    // 50% fuel is 128/255; 300 s run time is 0x012C
+    EXPECT_EQ(Build({0x01, 0x2F, 0x05, 0x1F}), (Bytes{0x41, 0x2F, 0x80, 0x1F, 0x01, 0x2C}));
+    EXPECT_EQ(Build({0x01, 0x01, 0x2F, 0x2F, 0x2F, 0x2F, 0x2F}).size(), 1u + 5 + 5 * 2);
+}
+
+TEST(PidTable, ComputesSupportedBitmaps)
+{
+    // Mode 01 serves 01, 1F and 2F: 0x00 flags 01, 1F and the next bitmap; 0x20 flags 2F
+    EXPECT_EQ(Build({0x01, 0x00, 0x20}),
+              (Bytes{0x41, 0x00, 0x80, 0x00, 0x00, 0x03, 0x20, 0x00, 0x02, 0x00, 0x00}));
+    EXPECT_TRUE(Obd2::Supported(0x01, 0x20));
+    EXPECT_FALSE(Obd2::Supported(0x01, 0x40));
+
+    // Mode 09 serves 02 and 0A, with no later bitmap
+    EXPECT_EQ(Build({0x09, 0x00}), (Bytes{0x49, 0x00, 0x40, 0x40, 0x00, 0x00}));
+    EXPECT_EQ(Build({0x09, 0x00, 0x20}), (Bytes{0x49, 0x00, 0x40, 0x40, 0x00, 0x00}));
+}
+
+TEST(PidTable, NegativeResponsesOnPhysicalRequests)
+{
+    Obd2::ResponseKind kind;
+    EXPECT_EQ(Build({0x03}, false, &kind), (Bytes{0x7F, 0x03, 0x11}));
+    EXPECT_EQ(kind, Obd2::ResponseKind::NEGATIVE);
+    EXPECT_EQ(Build({0x01, 0x05}), (Bytes{0x7F, 0x01, 0x12}));
+    EXPECT_EQ(Build({0x01, 0x40}), (Bytes{0x7F, 0x01, 0x12}));
+    EXPECT_EQ(Build({0x01}), (Bytes{0x7F, 0x01, 0x13}));
+    EXPECT_EQ(Build({0x01, 0x00, 0x01, 0x1F, 0x20, 0x2F, 0x00, 0x01}), (Bytes{0x7F, 0x01, 0x13}));
+}
+
+TEST(PidTable, SilentOnFunctionalRequestsItCannotServe)
+{
+    for (const Bytes& request : {Bytes{0x03}, Bytes{0x01, 0x05}, Bytes{0x01}, Bytes{0x09, 0x02, 0x0A}}) {
+        Obd2::ResponseKind kind;
+        EXPECT_TRUE(Build(request, true, &kind).empty());
+        EXPECT_EQ(kind, Obd2::ResponseKind::NONE);
+    }
+    EXPECT_EQ(Build({0x01, 0x2F}, true), (Bytes{0x41, 0x2F, 0x80}));
+}
+
+TEST(PidTable, VehicleInfoTakesOneDataPidPerRequest)
+{
+    EXPECT_EQ(Build({0x09, 0x02, 0x0A}), (Bytes{0x7F, 0x09, 0x13}));
+    EXPECT_EQ(Build({0x09, 0x00, 0x02}), (Bytes{0x7F, 0x09, 0x13}));
+    EXPECT_EQ(Build({0x09, 0x02}), TextResponse(0x02, kVin, 17));
+    EXPECT_EQ(Build({0x09, 0x0A}), TextResponse(0x0A, kEcuName, 20));
+}
+
+class Obd2ServerTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        publisher_.publish({50.0f, 1700000000000ull, 0});
+        int fds[2];
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds), 0);
+        tester_ = fds[1];
+        server_ = std::make_unique<Obd2::Obd2Server>(Obd2::Obd2ServerOptions{}, source_, fds[0]);
+    }
+
+    void TearDown() override
+    {
+        server_.reset();
+        close(tester_);
+    }
+
+    void Send(uint32_t id, const can_frame& frame)
+    {
+        can_frame copy = frame;
+        copy.can_id = id;
+        ASSERT_EQ(write(tester_, &copy, sizeof(copy)), static_cast<ssize_t>(sizeof(copy)));
+    }
+
+    void SendRequest(uint32_t id, const Bytes& request)
+    {
+        can_frame frame;
+        Obd2::MakeSingleFrame(id, request.data(), request.size(), Obd2::IsoTpOptions{}, frame);
+        Send(id, frame);
+    }
+
+    void SendFlowControl(Obd2::FlowStatus status, uint8_t block_size = 0, uint8_t st_min = 0)
+    {
+        can_frame frame;
+        Obd2::MakeFlowControl(kRequestId, status, block_size, st_min, Obd2::IsoTpOptions{}, frame);
+        Send(kRequestId, frame);
+    }
+
+    // Returns false if no frame arrives within the timeout
+    bool Receive(can_frame& frame, std::chrono::milliseconds timeout = 500ms)
+    {
+        pollfd fd{tester_, POLLIN, 0};
+        if (poll(&fd, 1, static_cast<int>(timeout.count())) != 1) return false;
+        return read(tester_, &frame, sizeof(frame)) == static_cast<ssize_t>(sizeof(frame));
+    }
+
+    Obd2::IsoTpClient Client(uint32_t request_id, uint8_t block_size = 0, uint8_t st_min = 0)
+    {
+        Obd2::IsoTpClientOptions options;
+        options.request_id = request_id;
+        options.block_size = block_size;
+        options.st_min = st_min;
+        return Obd2::IsoTpClient(tester_, options);
+    }
+
+    // Stats are updated on the server thread, so wait for them to settle
+    bool WaitFor(const std::function<bool(const Obd2::Obd2ServerStats&)>& done,
+                 std::chrono::milliseconds timeout = 2000ms)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!done(server_->stats())) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::sleep_for(5ms);
+        }
+        return true;
+    }
+
+    Streaming::FuelLevelPublisher publisher_{1000ms};
+    Obd2::VehicleStateSource source_{publisher_, kVin, kEcuName};
+    std::unique_ptr<Obd2::Obd2Server> server_;
+    int tester_ = -1;
+};
+
+TEST_F(Obd2ServerTest, AnswersFunctionalAndPhysicalSingleFrames)
+{
+    Bytes response;
+    std::string error;
+    auto functional = Client(kFunctionalId);
+    ASSERT_TRUE(functional.request(Bytes{0x01, 0x2F}.data(), 2, response, 500ms, &error)) << error;
+    EXPECT_EQ(response, (Bytes{0x41, 0x2F, 0x80}));
+
+    auto physical = Client(kRequestId);
+    ASSERT_TRUE(physical.request(Bytes{0x03}.data(), 1, response, 500ms, &error)) << error;
+    EXPECT_EQ(response, (Bytes{0x7F, 0x03, 0x11}));
+
+    EXPECT_TRUE(WaitFor([](const auto& stats) { return stats.responses == 2; }));
+    EXPECT_EQ(server_->stats().negative, 1u);
+}
+
+TEST_F(Obd2ServerTest, StaysSilentOnUnservedFunctionalRequests)
+{
+    SendRequest(kFunctionalId, {0x03});
+    SendRequest(kFunctionalId, {0x09, 0x02, 0x0A});
+    can_frame frame;
+    EXPECT_FALSE(Receive(frame, 200ms));
+    EXPECT_TRUE(WaitFor([](const auto& stats) { return stats.requests == 2; }));
+    EXPECT_EQ(server_->stats().responses, 0u);
+}
+
+TEST_F(Obd2ServerTest, SegmentsTheVinWithBlockSize)
+{
+    // 20 bytes: a first frame and two consecutive frames, each one its own block
+    Bytes response;
+    std::string error;
+    auto client = Client(kFunctionalId, 1);
+    ASSERT_TRUE(client.request(Bytes{0x09, 0x02}.data(), 2, response, 500ms, &error)) << error;
+    EXPECT_EQ(response, TextResponse(0x02, kVin, 17));
+    EXPECT_TRUE(WaitFor([](const auto& stats) { return stats.responses == 1; }));
+    EXPECT_EQ(server_->stats().segmented, 1u);
+    EXPECT_EQ(server_->stats().aborted, 0u);
+}
+
+TEST_F(Obd2ServerTest, HonoursSeparationTime)
+{
+    // 23 bytes: three consecutive frames, so at least two 20 ms gaps
+    Bytes response;
+    std::string error;
+    auto client = Client(kRequestId, 0, Obd2::EncodeSeparationTime(20ms));
+    auto started = std::chrono::steady_clock::now();
+    ASSERT_TRUE(client.request(Bytes{0x09, 0x0A}.data(), 2, response, 500ms, &error)) << error;
+    EXPECT_GE(std::chrono::steady_clock::now() - started, 40ms);
+    EXPECT_EQ(response, TextResponse(0x0A, kEcuName, 20));
+}
+
+TEST_F(Obd2ServerTest, WaitsOnFlowControlWait)
+{
+    SendRequest(kRequestId, {0x09, 0x02});
+    can_frame frame;
+    ASSERT_TRUE(Receive(frame));
+    EXPECT_EQ(frame.can_id, kResponseId);
+    EXPECT_EQ(Obd2::TypeOf(frame), Obd2::FrameType::FIRST);
+
+    SendFlowControl(Obd2::FlowStatus::WAIT);
+    SendFlowControl(Obd2::FlowStatus::WAIT);
+    EXPECT_FALSE(Receive(frame, 100ms));
+
+    SendFlowControl(Obd2::FlowStatus::CONTINUE);
+    for (uint8_t sequence = 1; sequence <= 2; ++sequence) {
+        ASSERT_TRUE(Receive(frame));
+        EXPECT_EQ(Obd2::TypeOf(frame), Obd2::FrameType::CONSECUTIVE);
+        EXPECT_EQ(frame.data[0] & 0x0F, sequence);
+    }
+    EXPECT_TRUE(WaitFor([](const auto& stats) { return stats.responses == 1; }));
+    EXPECT_EQ(server_->stats().aborted, 0u);
+}
+
+TEST_F(Obd2ServerTest, AbortsOnOverflow)
+{
+    SendRequest(kRequestId, {0x09, 0x02});
+    can_frame frame;
+    ASSERT_TRUE(Receive(frame));
+    SendFlowControl(Obd2::FlowStatus::OVERFLOW);
+    EXPECT_TRUE(WaitFor([](const auto& stats) { return stats.aborted == 1; }));
+    EXPECT_FALSE(Receive(frame, 100ms));
+    EXPECT_EQ(server_->stats().responses, 0u);
+}
+
+TEST_F(Obd2ServerTest, AbortsWhenFlowControlNeverComes)
+{
+    SendRequest(kRequestId, {0x09, 0x02});
+    can_frame frame;
+    ASSERT_TRUE(Receive(frame));
+
+    // N_Bs is 1 s
+    std::this_thread::sleep_for(500ms);
+    EXPECT_EQ(server_->stats().aborted, 0u);
+    EXPECT_TRUE(WaitFor([](const auto& stats) { return stats.aborted == 1; }, 1500ms));
+
+    // A late flow control is ignored
+    SendFlowControl(Obd2::FlowStatus::CONTINUE);
+    EXPECT_FALSE(Receive(frame, 100ms));
+}
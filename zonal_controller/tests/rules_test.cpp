@@ -0,0 +1,225 @@
+/**
+ * @file rules_test.cpp
+ * @brief Unit tests for the rule compiler and engine: negation, hysteresis and debounce
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#include <chrono>
+#include <string>
+#include <gtest/gtest.h>
+#include "rules/rule_compiler.h"
+#include "rules/rule_engine.h"
+
+namespace {
+    using namespace std::chrono_literals;
+
+    Rules::Program CompileOrFail(const std::string& condition)
+    {
+        Rules::Program program;
+        std::string error;
+        EXPECT_TRUE(Rules::Compile(condition, &program, &error)) << condition << ": " << error;
+        return program;
+    }
+
+    bool Eval(const Rules::Program& program, double fuel, double headlights, double hysteresis = 0.0)
+    {
+        return program.evaluate({fuel, headlights}, hysteresis);
+    }
+
+    // Adds a fuel level rule and returns a watcher for its events
+    Rules::RuleEngine::Watch AddRule(Rules::RuleEngine& engine, const std::string& condition, double hysteresis,
+                                     std::chrono::milliseconds debounce = 0ms)
+    {
+        Rules::RuleDefinition definition;
+        definition.id = "rule";
+        definition.condition = condition;
+        definition.hysteresis = hysteresis;
+        definition.debounce = debounce;
+        std::string error;
+        EXPECT_TRUE(engine.add_rule(definition, &error)) << error;
+        return engine.watch({}, false);
+    }
+
+    // Returns 1 for raised, 0 for cleared and -1 if no event arrives in time
+    int NextEvent(const Rules::RuleEngine::Watch& watch, std::chrono::milliseconds timeout = 500ms)
+    {
+        Rules::RuleEvent event;
+        if (watch.queue->pop(event, timeout) != Streaming::PopResult::ITEM) return -1;
+        return event.raised ? 1 : 0;
+    }
+}
+
+TEST(RuleCompiler, RejectsBadConditions)
+{
+    Rules::Program program;
+    std::string error;
+    EXPECT_FALSE(Rules::Compile("oil_level < 10", &program, &error));
+    EXPECT_NE(error.find("unknown signal"), std::string::npos);
+    EXPECT_FALSE(Rules::Compile("fuel_level <", &program, &error));
+    EXPECT_FALSE(Rules::Compile("(fuel_level < 10", &program, &error));
+    EXPECT_FALSE(Rules::Compile(std::string(40, '(') + "true" + std::string(40, ')'), &program, &error));
+}
+
+TEST(RuleCompiler, HysteresisWidensOrderedComparisons)
+{
+    auto below = CompileOrFail("fuel_level < 10");
+    EXPECT_TRUE(Eval(below, 9.9, 0));
+    EXPECT_FALSE(Eval(below, 11, 0));
+    EXPECT_TRUE(Eval(below, 11, 0, 2));
+    EXPECT_FALSE(Eval(below, 12.5, 0, 2));
+
+    auto above = CompileOrFail("fuel_level >= 90");
+    EXPECT_FALSE(Eval(above, 89, 0));
+    EXPECT_TRUE(Eval(above, 89, 0, 2));
+    EXPECT_FALSE(Eval(above, 87.5, 0, 2));
+}
+
+TEST(RuleCompiler, HysteresisWidensUnderNot)
+{
+    // Raised at or below 20; while raised it must stay raised up to 22
+    for (const char* condition : {"not (fuel_level > 20)", "!(fuel_level > 20)", "not fuel_level > 20"}) {
+        auto program = CompileOrFail(condition);
+        EXPECT_TRUE(Eval(program, 19, 0)) << condition;
+        EXPECT_FALSE(Eval(program, 21, 0)) << condition;
+        EXPECT_TRUE(Eval(program, 19, 0, 2)) << condition;
+        EXPECT_TRUE(Eval(program, 21, 0, 2)) << condition;
+        EXPECT_FALSE(Eval(program, 22.5, 0, 2)) << condition;
+    }
+
+    auto twice = CompileOrFail("not not (fuel_level < 10)");
+    EXPECT_TRUE(Eval(twice, 11, 0, 2));
+    EXPECT_FALSE(Eval(twice, 12.5, 0, 2));
+}
+
+TEST(RuleCompiler, NegationFollowsDeMorgan)
+{
+    auto program = CompileOrFail("not (fuel_level > 20 && headlights == 1 || fuel_level <= 5)");
+    for (double fuel : {0.0, 5.0, 10.0, 20.0, 30.0}) {
+        for (double headlights : {0.0, 1.0}) {
+            bool expected = !((fuel > 20 && headlights == 1) || fuel <= 5);
+            EXPECT_EQ(Eval(program, fuel, headlights), expected) << fuel << " " << headlights;
+        }
+    }
+
+    // The margin widens both negated thresholds: clears only above 22 or at 3 and below
+    auto band = CompileOrFail("not (fuel_level > 20 or fuel_level <= 5)");
+    EXPECT_TRUE(Eval(band, 21, 0, 2));
+    EXPECT_TRUE(Eval(band, 4, 0, 2));
+    EXPECT_FALSE(Eval(band, 22.5, 0, 2));
+    EXPECT_FALSE(Eval(band, 3, 0, 2));
+
+    auto value = CompileOrFail("!headlights && fuel_level < 50");
+    EXPECT_TRUE(Eval(value, 40, 0));
+    EXPECT_FALSE(Eval(value, 40, 1));
+}
+
+TEST(RuleCompiler, LongChainsCompile)
+{
+    std::string condition = "fuel_level < 0";
+    for (int i = 0; i < 10000; ++i) {
+        condition += " or fuel_level == " + std::to_string(i + 1000);
+    }
+    auto program = CompileOrFail("not (" + condition + ")");
+    EXPECT_TRUE(Eval(program, 50, 0));
+    EXPECT_FALSE(Eval(program, 5000, 0));
+}
+
+TEST(RuleCompiler, RejectsTooManyConstants)
+{
+    // Constant indexes are 16 bits; one past the limit must fail rather than wrap
+    std::string condition = "0";
+    for (int i = 0; i < 65535; ++i) {
+        condition += "||0";
+    }
+    Rules::Program program;
+    std::string error;
+    EXPECT_TRUE(Rules::Compile(condition, &program, &error)) << error;
+    EXPECT_FALSE(Rules::Compile(condition + "||1", &program, &error));
+    EXPECT_NE(error.find("too many constants"), std::string::npos);
+}
+
+TEST(RuleEngine, HysteresisDelaysClear)
+{
+    Rules::RuleEngine engine;
+    auto watch = AddRule(engine, "fuel_level < 10", 2);
+
+    engine.update(Rules::Signal::FUEL_LEVEL, 9);
+    EXPECT_EQ(NextEvent(watch), 1);
+    engine.update(Rules::Signal::FUEL_LEVEL, 11);
+    EXPECT_EQ(NextEvent(watch, 100ms), -1);
+    engine.update(Rules::Signal::FUEL_LEVEL, 12.5);
+    EXPECT_EQ(NextEvent(watch), 0);
+}
+
+TEST(RuleEngine, HysteresisDelaysClearUnderNot)
+{
+    Rules::RuleEngine engine;
+    auto watch = AddRule(engine, "not (fuel_level > 20)", 2);
+
+    engine.update(Rules::Signal::FUEL_LEVEL, 19);
+    EXPECT_EQ(NextEvent(watch), 1);
+    engine.update(Rules::Signal::FUEL_LEVEL, 21);
+    EXPECT_EQ(NextEvent(watch, 100ms), -1);
+    engine.update(Rules::Signal::FUEL_LEVEL, 23);
+    EXPECT_EQ(NextEvent(watch), 0);
+}
+
+TEST(RuleEngine, DebounceReportsLastingChanges)
+{
+    Rules::RuleEngine engine;
+    auto watch = AddRule(engine, "fuel_level < 10", 0, 200ms);
+
+    engine.update(Rules::Signal::FUEL_LEVEL, 5);
+    EXPECT_EQ(NextEvent(watch, 100ms), -1);
+    EXPECT_EQ(NextEvent(watch), 1);
+
+    engine.update(Rules::Signal::FUEL_LEVEL, 50);
+    EXPECT_EQ(NextEvent(watch, 100ms), -1);
+    EXPECT_EQ(NextEvent(watch), 0);
+}
+
+TEST(RuleEngine, DebounceIgnoresShortBlips)
+{
+    Rules::RuleEngine engine;
+    auto watch = AddRule(engine, "fuel_level < 10", 0, 200ms);
+
+    engine.update(Rules::Signal::FUEL_LEVEL, 50);
+    engine.update(Rules::Signal::FUEL_LEVEL, 5);
+    std::this_thread::sleep_for(50ms);
+    engine.update(Rules::Signal::FUEL_LEVEL, 50);
+    EXPECT_EQ(NextEvent(watch, 400ms), -1);
+}
+
+TEST(RuleEngine, RemovingRaisedRuleClearsIt)
+{
+    Rules::RuleEngine engine;
+    auto watch = AddRule(engine, "fuel_level < 10", 0);
+
+    engine.update(Rules::Signal::FUEL_LEVEL, 5);
+    EXPECT_EQ(NextEvent(watch), 1);
+    EXPECT_TRUE(engine.remove_rule("rule"));
+    EXPECT_EQ(NextEvent(watch), 0);
+    EXPECT_FALSE(engine.remove_rule("rule"));
+    EXPECT_EQ(NextEvent(watch, 100ms), -1);
+}
+
+TEST(RuleEngine, ReplacingRaisedRuleClearsBeforeRaising)
+{
+    Rules::RuleEngine engine;
+    auto watch = AddRule(engine, "fuel_level < 10", 0);
+
+    engine.update(Rules::Signal::FUEL_LEVEL, 5);
+    EXPECT_EQ(NextEvent(watch), 1);
+
+    // The replacement holds as well, so it raises again, but only after the old rule cleared
+    Rules::RuleDefinition definition;
+    definition.id = "rule";
+    definition.condition = "fuel_level < 20";
+    std::string error;
+    ASSERT_TRUE(engine.add_rule(definition, &error)) << error;
+    EXPECT_EQ(NextEvent(watch), 0);
+    EXPECT_EQ(NextEvent(watch), 1);
+    EXPECT_EQ(NextEvent(watch, 100ms), -1);
+}
@@ -0,0 +1,132 @@
+/**
+ * @file stream_merger_test.cpp
+ * @brief Unit tests for the aggregator's time-ordered merge of zone streams
+ * @author Auto SOA Team
+ * @version 1.0.0
+ * @date 2024-04-16
+ */
+
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "aggregator/stream_merger.h"
+
+namespace {
+    using namespace std::chrono_literals;
+    using Emitted = std::vector<std::pair<uint32_t, uint64_t>>;  // (zone, timestamp_ms)
+
+    class Recorder {
+    public:
+        Recorder(std::size_t zone_count, std::chrono::milliseconds reorder_window)
+            : merger_(zone_count, reorder_window, [this](const Streaming::FuelSample& sample) {
+                  emitted_.emplace_back(sample.zone, sample.timestamp_ms);
+              })
+        {
+            for (std::size_t zone = 0; zone < zone_count; ++zone) merger_.set_connected(zone, true);
+        }
+
+        void push(uint32_t zone, uint64_t timestamp_ms) { merger_.push({50.0f, timestamp_ms, zone}); }
+
+        Aggregator::StreamMerger& merger() { return merger_; }
+        const Emitted& emitted() const { return emitted_; }
+
+    private:
+        Emitted emitted_;
+        Aggregator::StreamMerger merger_;
+    };
+}
+
+TEST(StreamMerger, EmitsInterleavedZonesInTimestampOrder)
+{
+    Recorder recorder(3, 10s);
+    recorder.push(0, 100);
+    recorder.push(0, 130);
+    recorder.push(1, 110);
+    EXPECT_TRUE(recorder.emitted().empty());
+
+    // Zone 2 empties after 105, so 110 must wait for it again
+    recorder.push(2, 105);
+    EXPECT_EQ(recorder.emitted(), (Emitted{{0, 100}, {2, 105}}));
+
+    recorder.push(2, 120);
+    EXPECT_EQ(recorder.emitted(), (Emitted{{0, 100}, {2, 105}, {1, 110}}));
+
+    for (std::size_t zone = 0; zone < 3; ++zone) recorder.merger().set_connected(zone, false);
+    EXPECT_EQ(recorder.emitted(), (Emitted{{0, 100}, {2, 105}, {1, 110}, {2, 120}, {0, 130}}));
+
+    Aggregator::MergerStats stats = recorder.merger().stats();
+    EXPECT_EQ(stats.emitted, 5u);
+    EXPECT_EQ(stats.duplicates, 0u);
+    EXPECT_EQ(stats.late, 0u);
+}
+
+TEST(StreamMerger, DropsReplaysFromTheSameZone)
+{
+    Recorder recorder(2, 10s);
+    recorder.push(0, 100);
+    recorder.push(0, 100);
+    recorder.push(0, 90);
+    // The same timestamp from another zone is not a replay
+    recorder.push(1, 100);
+    recorder.push(1, 100);
+    recorder.push(1, 110);
+    recorder.push(0, 120);
+
+    EXPECT_EQ(recorder.emitted(), (Emitted{{0, 100}, {1, 100}, {1, 110}}));
+    Aggregator::MergerStats stats = recorder.merger().stats();
+    EXPECT_EQ(stats.emitted, 3u);
+    EXPECT_EQ(stats.duplicates, 3u);
+    EXPECT_EQ(stats.late, 0u);
+}
+
+TEST(StreamMerger, DropsSamplesOlderThanTheMergedFeed)
+{
+    Recorder recorder(2, 20ms);
+    recorder.push(0, 200);
+    recorder.merger().flush_expired();
+    EXPECT_TRUE(recorder.emitted().empty());
+
+    // Zone 1 stays quiet past the reorder window
+    std::this_thread::sleep_for(30ms);
+    recorder.merger().flush_expired();
+    EXPECT_EQ(recorder.emitted(), (Emitted{{0, 200}}));
+
+    recorder.push(1, 150);
+    recorder.push(1, 199);
+    recorder.push(1, 250);
+    recorder.push(0, 240);
+    EXPECT_EQ(recorder.emitted(), (Emitted{{0, 200}, {0, 240}}));
+
+    Aggregator::MergerStats stats = recorder.merger().stats();
+    EXPECT_EQ(stats.emitted, 2u);
+    EXPECT_EQ(stats.late, 2u);
+    EXPECT_EQ(stats.duplicates, 0u);
+}
+
+TEST(StreamMerger, DoesNotWaitForDisconnectedZones)
+{
+    Recorder recorder(2, 10s);
+    recorder.merger().set_connected(1, false);
+    recorder.push(0, 100);
+    recorder.push(0, 110);
+    EXPECT_EQ(recorder.emitted(), (Emitted{{0, 100}, {0, 110}}));
+
+    // Samples from a zone outside the merger are ignored
+    recorder.push(2, 120);
+    EXPECT_EQ(recorder.merger().stats().emitted, 2u);
+}
+
+TEST(StreamMerger, DropsOldestWhenAZoneBacklogIsFull)
+{
+    Recorder recorder(2, 10s);
+    for (uint64_t timestamp = 1; timestamp <= 300; ++timestamp) recorder.push(0, timestamp);
+    EXPECT_TRUE(recorder.emitted().empty());
+
+    recorder.merger().set_connected(1, false);
+    ASSERT_EQ(recorder.emitted().size(), 256u);
+    EXPECT_EQ(recorder.emitted().front().second, 45u);
+    EXPECT_EQ(recorder.emitted().back().second, 300u);
+    EXPECT_EQ(recorder.merger().stats().overflowed, 44u);
+}